@@ -0,0 +1,107 @@
+#include <osap.h>
+
+// -------------------------- This example measures small-message throughput across 
+// a link, w/ and w/o coalescing: both ends of a simulated point-to-point wire are 
+// gateways in this one runtime, and a blaster port sends 8, 16 and 32 byte messages 
+// to a counter port across it, as fast as it is clear to, reporting packets/sec over Serial. 
+// It also builds on the host, which is where we use it for benchmarking... 
+
+// a 2Mbit wire, w/ ~ the per-transfer cost of a full-speed usb bulk transfer, 
+#define WIRE_BITRATE 2000000 
+#define WIRE_FRAME_OVERHEAD_US 100 
+#define COALESCE_WINDOW_US 200 
+#define RUN_MICROS 500000 
+
+// -------------------------- Instantiate the OSAP Runtime, 
+
+OSAP_Runtime osap;
+
+// -------------------------- The wire, and its two ends (links 0 and 1), 
+
+OSAP_SimLinkWire wire(WIRE_BITRATE, WIRE_FRAME_OVERHEAD_US);
+OSAP_Gateway_SimLink linkA(&wire, 0);
+OSAP_Gateway_SimLink linkB(&wire, 1);
+
+// -------------------------- The counter counts, 
+
+class Counter : public VPort {
+  public:
+    Counter(void) : VPort(OSAP_Runtime::getInstance()) {}
+    void onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) override {
+      count ++;
+    }
+    uint32_t count = 0;
+};
+
+Counter counter; // port 0 
+
+// -------------------------- The blaster blasts, out of link 0 to the counter, 
+
+class Blaster : public VPort {
+  public:
+    Blaster(void) : VPort(OSAP_Runtime::getInstance()) {}
+    void onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) override {}
+    void blast(size_t len){
+      while(clearToSend()){
+        send(msg, len, &route, 0);
+        sent ++;
+      }
+    }
+    Route route;
+    uint8_t msg[32] = { 0 };
+    uint32_t sent = 0;
+};
+
+Blaster blaster; // port 1 
+
+// -------------------------- Runs one size, returns packets/sec 
+
+uint32_t run(size_t len, uint32_t window){
+  linkA.setCoalescing(window);
+  linkB.setCoalescing(window);
+  counter.count = 0;
+  blaster.sent = 0;
+  uint32_t start = micros();
+  while(micros() - start < RUN_MICROS){
+    blaster.blast(len);
+    osap.loop();
+  }
+  // drain what's in flight, so we count whole runs 
+  uint32_t drainStart = micros();
+  while(counter.count < blaster.sent && micros() - drainStart < 100000){
+    osap.loop();
+  }
+  uint32_t elapsed = micros() - start;
+  return (uint64_t)counter.count * 1000000 / elapsed;
+}
+
+// -------------------------- Arduino Setup
+
+void setup() {
+  Serial.begin(9600);
+  blaster.route.linkf(0)->end(1000);
+  osap.begin();
+}
+
+// -------------------------- Arduino Loop
+
+boolean reported = false;
+
+void loop() {
+  if(reported){
+    osap.loop();
+    return;
+  }
+  const size_t sizes[3] = { 8, 16, 32 };
+  for(uint8_t s = 0; s < 3; s ++){
+    uint32_t framesBefore = wire.framesCarried;
+    uint32_t plain = run(sizes[s], 0);
+    uint32_t plainFrames = wire.framesCarried - framesBefore;
+    framesBefore = wire.framesCarried;
+    uint32_t batched = run(sizes[s], COALESCE_WINDOW_US);
+    uint32_t batchedFrames = wire.framesCarried - framesBefore;
+    Serial.println(String(sizes[s]) + " byte msgs, pck/s plain / coalesced: " + String(plain) + " / " + String(batched) + 
+      ", frames: " + String(plainFrames) + " / " + String(batchedFrames));
+  }
+  reported = true;
+}
@@ -0,0 +1,117 @@
+#include <osap.h>
+
+// -------------------------- This example runs a whole time-slotted bus 
+// inside one device: a head and N drops share a simulated wire, and a pinger port 
+// sends round-trips to a ponger port through each drop in turn, reporting 
+// per-drop latency, worst-case bus cycle time, and wire utilization over Serial. 
+// It also builds on the host, which is where we use it for benchmarking... 
+
+#define BUS_BITRATE 1000000 
+// the head and drops are all bus gateways in this one runtime, 
+// so we fit within OSAP_CONFIG_MAX_BGATEWAYS (8) 
+#define BUS_DROPS 7 
+#define BUS_SLOT_WIDTH_US 400 
+#define PINGS_PER_DROP 64 
+
+// -------------------------- Instantiate the OSAP Runtime, 
+
+OSAP_Runtime osap;
+
+// -------------------------- The wire, the head (bus index 0, address 0), and drops, 
+
+OSAP_SimBusMedium wire(BUS_BITRATE);
+OSAP_Gateway_SimBusTDMA head(&wire, 0, true);
+OSAP_Gateway_SimBusTDMA drop1(&wire, 1, false);
+OSAP_Gateway_SimBusTDMA drop2(&wire, 2, false);
+OSAP_Gateway_SimBusTDMA drop3(&wire, 3, false);
+OSAP_Gateway_SimBusTDMA drop4(&wire, 4, false);
+OSAP_Gateway_SimBusTDMA drop5(&wire, 5, false);
+OSAP_Gateway_SimBusTDMA drop6(&wire, 6, false);
+OSAP_Gateway_SimBusTDMA drop7(&wire, 7, false);
+
+// -------------------------- The ponger echoes whatever it gets, 
+
+class Ponger : public VPort {
+  public:
+    Ponger(void) : VPort(OSAP_Runtime::getInstance()) {}
+    void onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) override {
+      send(data, len, sourceRoute, sourcePort);
+    }
+};
+
+Ponger ponger; // port 0 
+
+// -------------------------- The pinger sends to the ponger via each drop, 
+
+class Pinger : public VPort {
+  public:
+    Pinger(void) : VPort(OSAP_Runtime::getInstance()) {}
+    void onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) override {
+      uint32_t rtt = micros() - sentAt;
+      uint8_t d = data[0];
+      if(rtt < minRtt[d]) minRtt[d] = rtt;
+      if(rtt > maxRtt[d]) maxRtt[d] = rtt;
+      sumRtt[d] += rtt;
+      count[d] ++;
+      awaiting = false;
+    }
+    void ping(uint8_t drop){
+      Route route;
+      route.busf(0, drop + 1)->end(100);
+      uint8_t msg[8] = { drop };
+      sentAt = micros();
+      awaiting = true;
+      send(msg, 8, &route, 0);
+    }
+    uint32_t sentAt = 0;
+    boolean awaiting = false;
+    uint32_t minRtt[BUS_DROPS];
+    uint32_t maxRtt[BUS_DROPS] = { 0 };
+    uint32_t sumRtt[BUS_DROPS] = { 0 };
+    uint32_t count[BUS_DROPS] = { 0 };
+};
+
+Pinger pinger; // port 1 
+
+// -------------------------- Arduino Setup
+
+void setup() {
+  Serial.begin(9600);
+  head.setSlotWidth(BUS_SLOT_WIDTH_US);
+  for(uint8_t d = 0; d < BUS_DROPS; d ++) pinger.minRtt[d] = 0xFFFFFFFF;
+  osap.begin();
+}
+
+// -------------------------- Arduino Loop
+
+uint8_t currentDrop = 0;
+uint32_t pings = 0;
+uint32_t lastPingAt = 0;
+boolean reported = false;
+
+void loop() {
+  osap.loop();
+  if(reported) return;
+  // wait for every drop to join the slot table, 
+  for(uint8_t d = 0; d < BUS_DROPS; d ++){
+    if(!head.isOpen(d + 1)) return;
+  }
+  // ping round-robin, re-trying anything lost, 
+  if((!pinger.awaiting || micros() - lastPingAt > 100000) && pinger.clearToSend()){
+    if(pings >= (uint32_t)PINGS_PER_DROP * BUS_DROPS){
+      // done: report 
+      for(uint8_t d = 0; d < BUS_DROPS; d ++){
+        Serial.println("drop " + String(d + 1) + " rtt us min / avg / max: " + String(pinger.minRtt[d]) + " / " + String(pinger.count[d] ? pinger.sumRtt[d] / pinger.count[d] : 0) + " / " + String(pinger.maxRtt[d]));
+      }
+      // the head's slot, and one per drop, see bus_tdma.h 
+      Serial.println("max cycle us: " + String(head.maxCycleMicros) + ", bound: " + String((uint32_t)TDMA_CYCLE_BOUND_US(BUS_DROPS + 1, BUS_SLOT_WIDTH_US, BUS_BITRATE)));
+      Serial.println("wire frames: " + String(wire.framesCarried) + ", collisions: " + String(wire.collisions) + ", utilization %: " + String((uint32_t)(((uint64_t)wire.busyMicros * 100) / micros())));
+      reported = true;
+      return;
+    }
+    pinger.ping(currentDrop);
+    lastPingAt = micros();
+    currentDrop = (currentDrop + 1) % BUS_DROPS;
+    pings ++;
+  }
+}
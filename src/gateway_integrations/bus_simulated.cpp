@@ -0,0 +1,139 @@
+// software bus 
+
+#include "bus_simulated.h"
+#include "../packets/packets.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+
+// ---------------------------------------------- The Medium 
+
+OSAP_SimBusMedium::OSAP_SimBusMedium(uint32_t _bitRate){
+  bitRate = _bitRate;
+}
+
+int8_t OSAP_SimBusMedium::attach(uint16_t address){
+  if(dropCount >= SIMBUS_MAX_DROPS) return -1;
+  addresses[dropCount] = address;
+  return dropCount ++;
+}
+
+boolean OSAP_SimBusMedium::isIdle(void){
+  return (pendingListeners == 0 && (int32_t)(micros() - busyUntil) >= 0);
+}
+
+void OSAP_SimBusMedium::transmit(uint8_t sourceSlot, uint8_t* data, size_t len){
+  // nothing we attach can send more than this, 
+  if(len > sizeof(frame)) return;
+  // talking over someone else garbles both, 
+  if(!isIdle()){
+    collisions ++;
+    pendingListeners = 0;
+    return;
+  }
+  memcpy(frame, data, len);
+  frameLen = len;
+  frameSource = addresses[sourceSlot];
+  // everyone-but-the-sender hears it, 
+  pendingListeners = (uint16_t)((1UL << dropCount) - 1) & ~(1 << sourceSlot);
+  framesCarried ++;
+  bytesCarried += len;
+  // after it's finished arriving, 
+  uint32_t airtime = bitRate ? TDMA_AIRTIME_US(len, bitRate) : 0;
+  busyUntil = micros() + airtime;
+  busyMicros += airtime;
+}
+
+boolean OSAP_SimBusMedium::hasFrameFor(uint8_t slot){
+  return (pendingListeners & (1 << slot)) && (int32_t)(micros() - busyUntil) >= 0;
+}
+
+void OSAP_SimBusMedium::markHeard(uint8_t slot){
+  pendingListeners &= ~(1 << slot);
+}
+
+boolean OSAP_SimBusMedium::hasAddress(uint16_t address){
+  for(uint8_t d = 0; d < dropCount; d ++){
+    if(addresses[d] == address) return true;
+  }
+  return false;
+}
+
+// ---------------------------------------------- The Drop 
+
+OSAP_Gateway_SimBus::OSAP_Gateway_SimBus(OSAP_SimBusMedium* _medium, uint16_t _address) : 
+  BGateway(OSAP_Runtime::getInstance(), _address)
+{
+  typeKey = BGATEWAYTYPEKEY_SIMULATED;
+  medium = _medium;
+  slot = medium->attach(address);
+}
+
+void OSAP_Gateway_SimBus::begin(void){}
+
+void OSAP_Gateway_SimBus::loop(void){
+  if(slot < 0) return;
+  // if there's a frame for us and we have space, hear it: 
+  // the gateway's ingest does the address / channel filtering 
+  if(medium->hasFrameFor(slot) && medium->frameLen > OSAP_CONFIG_PACKET_MAX_SIZE){
+    // a (TDMA-framed) packet w/ its header won't fit, and isn't for us anyways 
+    medium->markHeard(slot);
+  } else if(medium->hasFrameFor(slot) && getPacketCheck(this)){
+    VPacket* pck = getPacketFromStack(this);
+    memcpy(pck->data, medium->frame, medium->frameLen);
+    pck->len = medium->frameLen;
+    medium->markHeard(slot);
+    ingestPacket(pck, medium->frameSource);
+  }
+}
+
+boolean OSAP_Gateway_SimBus::clearToSend(uint16_t address){
+  return (slot >= 0 && medium->isIdle());
+}
+
+boolean OSAP_Gateway_SimBus::isOpen(uint16_t address){
+  return medium->hasAddress(address);
+}
+
+void OSAP_Gateway_SimBus::send(uint16_t address, uint8_t* data, size_t len){
+  // the address is in the packet's instruction, so this medium 
+  // doesn't need to frame it separately 
+  medium->transmit(slot, data, len);
+}
+
+boolean OSAP_Gateway_SimBus::clearToBroadcast(uint16_t channel){
+  return clearToSend(0);
+}
+
+void OSAP_Gateway_SimBus::broadcast(uint16_t channel, uint8_t* data, size_t len){
+  medium->transmit(slot, data, len);
+}
+
+// ---------------------------------------------- The Time-Slotted Drop 
+
+OSAP_Gateway_SimBusTDMA::OSAP_Gateway_SimBusTDMA(OSAP_SimBusMedium* _medium, uint16_t _address, boolean _isHead) : 
+  BGateway_TDMA(OSAP_Runtime::getInstance(), _address, _isHead)
+{
+  typeKey = BGATEWAYTYPEKEY_SIMULATED;
+  medium = _medium;
+  slot = medium->attach(address);
+}
+
+void OSAP_Gateway_SimBusTDMA::phyBegin(void){}
+
+void OSAP_Gateway_SimBusTDMA::phyLoop(void){
+  if(slot < 0) return;
+  if(medium->hasFrameFor(slot)){
+    medium->markHeard(slot);
+    onPhyFrame(medium->frame, medium->frameLen);
+  }
+}
+
+boolean OSAP_Gateway_SimBusTDMA::phyClearToTransmit(void){
+  return (slot >= 0 && medium->isIdle());
+}
+
+void OSAP_Gateway_SimBusTDMA::phyTransmit(uint8_t* frame, size_t len){
+  medium->transmit(slot, frame, len);
+}
+
+#endif 
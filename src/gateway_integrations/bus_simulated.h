@@ -0,0 +1,83 @@
+// a software-only shared bus, for host builds and loopback testing of bus routes 
+
+#ifndef BUS_SIMULATED_H_
+#define BUS_SIMULATED_H_
+
+#include "../structure/busses.h"
+#include "../structure/bus_tdma.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+
+#define SIMBUS_MAX_DROPS 16 
+
+// the medium is one frame wide, like a half-duplex wire: a frame stays 
+// "on the wire" until every other attached drop has heard it, 
+// w/ a nonzero bitRate, frames also take airtime (10 bits per byte, as on a UART) 
+// and transmitting over a busy wire is a collision: nobody hears either frame 
+class OSAP_SimBusMedium {
+  public:
+    OSAP_SimBusMedium(uint32_t _bitRate = 0);
+    // attaches a drop at this bus address, returns its slot or -1 if full 
+    int8_t attach(uint16_t address);
+    // true if nothing is on the wire, 
+    boolean isIdle(void);
+    // put a frame on the wire, 
+    void transmit(uint8_t sourceSlot, uint8_t* data, size_t len);
+    // true if the drop in this slot has yet to hear the current frame 
+    boolean hasFrameFor(uint8_t slot);
+    // the drop in this slot has heard it, 
+    void markHeard(uint8_t slot);
+    // lookup by bus address, 
+    boolean hasAddress(uint16_t address);
+
+    // wide enough for a whole packet in a TDMA frame, 
+    uint8_t frame[OSAP_CONFIG_PACKET_MAX_SIZE + TDMA_HEADER_SIZE];
+    size_t frameLen = 0;
+    uint16_t frameSource = 0;
+    // and counts, for benchmarking, 
+    uint32_t framesCarried = 0;
+    uint32_t bytesCarried = 0;
+    uint32_t collisions = 0;
+    // and the time the wire spent carrying bytes, for utilization 
+    uint32_t busyMicros = 0;
+
+  private:
+    uint16_t addresses[SIMBUS_MAX_DROPS];
+    uint8_t dropCount = 0;
+    // one bit per slot that has yet to hear the frame on the wire 
+    uint16_t pendingListeners = 0;
+    uint32_t bitRate = 0;
+    uint32_t busyUntil = 0;
+};
+
+class OSAP_Gateway_SimBus : public BGateway {
+  public:
+    OSAP_Gateway_SimBus(OSAP_SimBusMedium* _medium, uint16_t _address);
+    void begin(void) override;
+    void loop(void) override;
+    boolean clearToSend(uint16_t address) override;
+    boolean isOpen(uint16_t address) override;
+    void send(uint16_t address, uint8_t* data, size_t len) override;
+    boolean clearToBroadcast(uint16_t channel) override;
+    void broadcast(uint16_t channel, uint8_t* data, size_t len) override;
+  private:
+    OSAP_SimBusMedium* medium;
+    int8_t slot = -1;
+};
+
+// and a time-slotted drop, w/ the medium as its PHY 
+class OSAP_Gateway_SimBusTDMA : public BGateway_TDMA {
+  public:
+    OSAP_Gateway_SimBusTDMA(OSAP_SimBusMedium* _medium, uint16_t _address, boolean _isHead);
+    void phyBegin(void) override;
+    void phyLoop(void) override;
+    boolean phyClearToTransmit(void) override;
+    void phyTransmit(uint8_t* frame, size_t len) override;
+  private:
+    OSAP_SimBusMedium* medium;
+    int8_t slot = -1;
+};
+
+#endif 
+
+#endif 
@@ -0,0 +1,104 @@
+// packing small packets into shared link frames 
+
+#include "link_coalesce.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_LINK_COALESCING
+
+// ---------------------------------------------- Tx 
+
+void LinkCoalescer::setWindow(uint32_t windowMicros){
+  window = windowMicros;
+}
+
+boolean LinkCoalescer::isEnabled(void){
+  return window > 0;
+}
+
+boolean LinkCoalescer::push(uint8_t* data, size_t len){
+  // packets too big to batch can still wait here alone, as-is, 
+  if(txLen == 0 && len + 2 > OSAP_CONFIG_LINK_COALESCE_MAX_FRAME){
+    if(len > OSAP_CONFIG_LINK_COALESCE_MAX_FRAME) return false;
+    memcpy(tx, data, len);
+    txLen = len;
+    txCount = 1;
+    txRaw = true;
+    return true;
+  }
+  if(txRaw) return false;
+  // the key, then a length byte per packet, 
+  uint16_t start = (txLen == 0) ? 1 : txLen;
+  if(len > 255 || start + 1 + len > OSAP_CONFIG_LINK_COALESCE_MAX_FRAME) return false;
+  if(txLen == 0){
+    tx[0] = LINK_BATCH_KEY;
+    txFirstAt = micros();
+  }
+  tx[start] = len;
+  memcpy(&(tx[start + 1]), data, len);
+  txLen = start + 1 + len;
+  txCount ++;
+  return true;
+}
+
+boolean LinkCoalescer::shouldFlush(void){
+  if(txLen == 0) return false;
+  if(txRaw) return true;
+  // nearly full: another min-size packet (5 head + key) wouldn't fit, 
+  if(txLen + 8 > OSAP_CONFIG_LINK_COALESCE_MAX_FRAME) return true;
+  return (micros() - txFirstAt >= window);
+}
+
+boolean LinkCoalescer::isEmpty(void){
+  return txLen == 0;
+}
+
+size_t LinkCoalescer::take(uint8_t* dest){
+  size_t len;
+  if(txRaw){
+    len = txLen;
+    memcpy(dest, tx, len);
+  } else if(txCount == 1){
+    // a batch of one is just the packet, 
+    len = tx[1];
+    memcpy(dest, &(tx[2]), len);
+  } else {
+    len = txLen;
+    memcpy(dest, tx, len);
+  }
+  framesOut ++;
+  packetsOut += txCount;
+  txLen = 0;
+  txCount = 0;
+  txRaw = false;
+  return len;
+}
+
+// ---------------------------------------------- Rx 
+
+size_t LinkCoalescer::unpack(uint8_t* frame, size_t len){
+  if(len == 0 || frame[0] != LINK_BATCH_KEY) return len;
+  // hold the batch, and hand back its first, 
+  if(len > OSAP_CONFIG_LINK_COALESCE_MAX_FRAME) len = OSAP_CONFIG_LINK_COALESCE_MAX_FRAME;
+  memcpy(rx, frame, len);
+  rxLen = len;
+  rxRp = 1;
+  return next(frame);
+}
+
+boolean LinkCoalescer::available(void){
+  return rxRp < rxLen;
+}
+
+size_t LinkCoalescer::next(uint8_t* dest){
+  if(rxRp >= rxLen) return 0;
+  size_t len = rx[rxRp];
+  // guard against a garbled length, 
+  if(rxRp + 1 + len > rxLen){
+    rxRp = rxLen;
+    return 0;
+  }
+  memcpy(dest, &(rx[rxRp + 1]), len);
+  rxRp += 1 + len;
+  return len;
+}
+
+#endif 
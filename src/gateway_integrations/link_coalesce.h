@@ -0,0 +1,55 @@
+// packing small packets into shared link frames, for link-implementers 
+
+#ifndef LINK_COALESCE_H_
+#define LINK_COALESCE_H_
+
+#include <Arduino.h>
+#include "../osap_config.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_LINK_COALESCING
+
+// a batch frame is | LINK_BATCH_KEY | LEN | PACKET | LEN | PACKET | ... |, 
+// packets always start w/ their PTR (>= 5), so a leading zero can't be confused w/ one, 
+// and a batch of one goes out as the bare packet, so peers that don't batch can still read us 
+#define LINK_BATCH_KEY 0 
+
+class LinkCoalescer {
+  public:
+    // -------------------------------- Tx 
+    // how long the first packet in a batch may wait for company, 0 is off 
+    void setWindow(uint32_t windowMicros);
+    boolean isEnabled(void);
+    // add a packet, returns false if it doesn't fit (flush, then add it again) 
+    boolean push(uint8_t* data, size_t len);
+    // true if we have a batch and it's time (or it's nearly full), 
+    boolean shouldFlush(void);
+    boolean isEmpty(void);
+    // writes the frame into dest, returns its length, and resets 
+    size_t take(uint8_t* dest);
+
+    // -------------------------------- Rx 
+    // link frames go through here, batches are held and returned one packet at a time, 
+    // returns the length of the first (or only) packet, now in frame 
+    size_t unpack(uint8_t* frame, size_t len);
+    // more held from the last batch ? 
+    boolean available(void);
+    size_t next(uint8_t* dest);
+
+    // -------------------------------- Stats 
+    uint32_t framesOut = 0;
+    uint32_t packetsOut = 0;
+
+  private:
+    uint32_t window = 0;
+    uint8_t tx[OSAP_CONFIG_LINK_COALESCE_MAX_FRAME];
+    uint16_t txLen = 0;
+    uint8_t txCount = 0;
+    boolean txRaw = false;
+    uint32_t txFirstAt = 0;
+    uint8_t rx[OSAP_CONFIG_LINK_COALESCE_MAX_FRAME];
+    uint16_t rxLen = 0;
+    uint16_t rxRp = 0;
+};
+
+#endif 
+#endif 
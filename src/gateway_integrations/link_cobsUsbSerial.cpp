@@ -36,6 +36,25 @@ void OSAP_Gateway_USBSerial::begin(void){
 void OSAP_Gateway_USBSerial::loop(void){
   // run the code... 
   cobsUsbSerialLink.loop();
+  #ifdef OSAP_CONFIG_INCLUDE_LINK_COALESCING
+  // ship batches that have waited long enough, 
+  if(coalescer.shouldFlush() && cobsUsbSerialLink.clearToSend()){
+    uint8_t frame[OSAP_CONFIG_LINK_COALESCE_MAX_FRAME];
+    size_t len = coalescer.take(frame);
+    cobsUsbSerialLink.send(frame, len);
+  }
+  // and drain the rest of the last batch we rx'd before reading more, 
+  if(getPacketCheck(this) && coalescer.available()){
+    VPacket* pck = getPacketFromStack(this);
+    pck->len = coalescer.next(pck->data);
+    if(pck->len == 0){
+      relinquishPacketToStack(pck);
+    } else {
+      ingestPacket(pck);
+    }
+    return;
+  }
+  #endif 
   // if we can allocate on the message stack & also have packets, 
   if(getPacketCheck(this) && cobsUsbSerialLink.clearToRead()){
     // allocate the packet to us, 
@@ -43,6 +62,14 @@ void OSAP_Gateway_USBSerial::loop(void){
     // this pattern lets us avoid doing two memcpy's on the data, 
     // here we write it direct into the stack: 
     pck->len = cobsUsbSerialLink.getPacket(pck->data);
+    #ifdef OSAP_CONFIG_INCLUDE_LINK_COALESCING
+    // batches are held, and we get the first one back, 
+    pck->len = coalescer.unpack(pck->data, pck->len);
+    if(pck->len == 0){
+      relinquishPacketToStack(pck);
+      return;
+    }
+    #endif 
     // and run this ute to reverse the route & increment the pointer 
     ingestPacket(pck);
   }
@@ -57,5 +84,29 @@ boolean OSAP_Gateway_USBSerial::isOpen(void){
 }
 
 void OSAP_Gateway_USBSerial::send(uint8_t* data, size_t len){
+  #ifdef OSAP_CONFIG_INCLUDE_LINK_COALESCING
+  if(coalescer.isEnabled()){
+    // we're only clear-to-send when the link is, so we can always flush to make room, 
+    if(coalescer.push(data, len)) return;
+    if(!coalescer.isEmpty()){
+      uint8_t frame[OSAP_CONFIG_LINK_COALESCE_MAX_FRAME];
+      size_t frameLen = coalescer.take(frame);
+      cobsUsbSerialLink.send(frame, frameLen);
+      // and start the next batch w/ this one, 
+      if(coalescer.push(data, len)) return;
+      // or, if it's larger than a batch can be, the link queues it behind that frame 
+    }
+  }
+  #endif 
   cobsUsbSerialLink.send(data, len);
-}
\ No newline at end of file
+}
+
+uint16_t OSAP_Gateway_USBSerial::getMTU(void){
+  return cobsUsbSerialLink.getMTU();
+}
+
+#ifdef OSAP_CONFIG_INCLUDE_LINK_COALESCING
+void OSAP_Gateway_USBSerial::setCoalescing(uint32_t windowMicros){
+  coalescer.setWindow(windowMicros);
+}
+#endif 
\ No newline at end of file
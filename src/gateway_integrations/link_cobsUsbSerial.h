@@ -7,6 +7,7 @@
 // it'll happen via <COBSUSBSerial.h> right ? 
 #include "../lib/COBSerial/COBSUSBSerial.h"
 #include "../structure/links.h"
+#include "link_coalesce.h"
 
 class OSAP_Gateway_USBSerial : public LGateway {
   public:
@@ -26,6 +27,14 @@ class OSAP_Gateway_USBSerial : public LGateway {
     boolean isOpen(void) override;
     // transmit along 
     void send(uint8_t* data, size_t len) override;
+    // as negotiated w/ the other end, 
+    uint16_t getMTU(void) override;
+    #ifdef OSAP_CONFIG_INCLUDE_LINK_COALESCING
+    // pack packets sent within this window into one frame, 0 is off (the default), 
+    // the other end needs to understand batches (see link_coalesce.h) 
+    void setCoalescing(uint32_t windowMicros);
+    LinkCoalescer coalescer;
+    #endif 
   private: 
     COBSUSBSerial cobsUsbSerialLink;
 };
@@ -0,0 +1,121 @@
+// software link 
+
+#include "link_simulated.h"
+#include "../packets/packets.h"
+
+// ---------------------------------------------- The Wire 
+
+OSAP_SimLinkWire::OSAP_SimLinkWire(uint32_t _bitRate, uint32_t _frameOverheadMicros){
+  bitRate = _bitRate;
+  frameOverheadMicros = _frameOverheadMicros;
+}
+
+boolean OSAP_SimLinkWire::isClear(uint8_t side){
+  return frameLens[side] == 0;
+}
+
+void OSAP_SimLinkWire::transmit(uint8_t side, uint8_t* data, size_t len){
+  if(len > OSAP_CONFIG_PACKET_MAX_SIZE) len = OSAP_CONFIG_PACKET_MAX_SIZE;
+  memcpy(frames[side], data, len);
+  frameLens[side] = len;
+  // cobs adds a byte, and the delimiter another, 
+  uint32_t airtime = frameOverheadMicros + (bitRate ? ((len + 2) * 10 * 1000000UL) / bitRate : 0);
+  arrivesAt[side] = micros() + airtime;
+  framesCarried ++;
+  bytesCarried += len;
+  busyMicros += airtime;
+}
+
+boolean OSAP_SimLinkWire::hasFrameFor(uint8_t side){
+  // frames for us are on the other side's lane, 
+  uint8_t lane = side ^ 1;
+  return frameLens[lane] > 0 && (int32_t)(micros() - arrivesAt[lane]) >= 0;
+}
+
+size_t OSAP_SimLinkWire::receive(uint8_t side, uint8_t* dest){
+  uint8_t lane = side ^ 1;
+  size_t len = frameLens[lane];
+  memcpy(dest, frames[lane], len);
+  frameLens[lane] = 0;
+  return len;
+}
+
+// ---------------------------------------------- The Gateway 
+
+OSAP_Gateway_SimLink::OSAP_Gateway_SimLink(OSAP_SimLinkWire* _wire, uint8_t _side) : 
+  LGateway(OSAP_Runtime::getInstance())
+{
+  typeKey = LGATEWAYTYPEKEY_SIMULATED;
+  wire = _wire;
+  side = _side & 1;
+}
+
+void OSAP_Gateway_SimLink::begin(void){}
+
+void OSAP_Gateway_SimLink::loop(void){
+  #ifdef OSAP_CONFIG_INCLUDE_LINK_COALESCING
+  // ship batches that have waited long enough, 
+  if(coalescer.shouldFlush() && wire->isClear(side)){
+    uint8_t frame[OSAP_CONFIG_LINK_COALESCE_MAX_FRAME];
+    size_t len = coalescer.take(frame);
+    wire->transmit(side, frame, len);
+  }
+  // and drain the rest of the last batch we rx'd before reading more, 
+  if(getPacketCheck(this) && coalescer.available()){
+    VPacket* pck = getPacketFromStack(this);
+    pck->len = coalescer.next(pck->data);
+    if(pck->len == 0){
+      relinquishPacketToStack(pck);
+    } else {
+      ingestPacket(pck);
+    }
+    return;
+  }
+  #endif 
+  if(getPacketCheck(this) && wire->hasFrameFor(side)){
+    VPacket* pck = getPacketFromStack(this);
+    pck->len = wire->receive(side, pck->data);
+    #ifdef OSAP_CONFIG_INCLUDE_LINK_COALESCING
+    pck->len = coalescer.unpack(pck->data, pck->len);
+    if(pck->len == 0){
+      relinquishPacketToStack(pck);
+      return;
+    }
+    #endif 
+    ingestPacket(pck);
+  }
+}
+
+boolean OSAP_Gateway_SimLink::clearToSend(void){
+  return wire->isClear(side);
+}
+
+boolean OSAP_Gateway_SimLink::isOpen(void){
+  return true;
+}
+
+void OSAP_Gateway_SimLink::send(uint8_t* data, size_t len){
+  #ifdef OSAP_CONFIG_INCLUDE_LINK_COALESCING
+  if(coalescer.isEnabled()){
+    if(coalescer.push(data, len)) return;
+    if(!coalescer.isEmpty()){
+      uint8_t frame[OSAP_CONFIG_LINK_COALESCE_MAX_FRAME];
+      size_t frameLen = coalescer.take(frame);
+      wire->transmit(side, frame, frameLen);
+      coalescer.push(data, len);
+      return;
+    }
+  }
+  #endif 
+  wire->transmit(side, data, len);
+}
+
+uint16_t OSAP_Gateway_SimLink::getMTU(void){
+  return OSAP_CONFIG_PACKET_MAX_SIZE;
+}
+
+#ifdef OSAP_CONFIG_INCLUDE_LINK_COALESCING
+void OSAP_Gateway_SimLink::setCoalescing(uint32_t windowMicros){
+  coalescer.setWindow(windowMicros);
+}
+#endif 
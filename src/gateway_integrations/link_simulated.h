@@ -0,0 +1,55 @@
+// a software-only point-to-point link, for host builds and loopback benchmarks 
+
+#ifndef LINK_SIMULATED_H_
+#define LINK_SIMULATED_H_
+
+#include "../structure/links.h"
+#include "link_coalesce.h"
+
+// the wire has two lanes, one per direction, each one frame wide: a frame takes 
+// a fixed per-frame overhead (i.e. a USB transfer, or a UART's inter-frame gap) 
+// plus airtime for its bytes and COBS framing (10 bits per byte), and the lane 
+// stays full until the far side reads it, which is the link's flow control 
+class OSAP_SimLinkWire {
+  public:
+    OSAP_SimLinkWire(uint32_t _bitRate = 0, uint32_t _frameOverheadMicros = 0);
+    // side 0 or 1, 
+    boolean isClear(uint8_t side);
+    void transmit(uint8_t side, uint8_t* data, size_t len);
+    boolean hasFrameFor(uint8_t side);
+    size_t receive(uint8_t side, uint8_t* dest);
+
+    // counts, for benchmarking, 
+    uint32_t framesCarried = 0;
+    uint32_t bytesCarried = 0;
+    uint32_t busyMicros = 0;
+
+  private:
+    uint32_t bitRate;
+    uint32_t frameOverheadMicros;
+    uint8_t frames[2][OSAP_CONFIG_PACKET_MAX_SIZE];
+    size_t frameLens[2] = { 0, 0 };
+    uint32_t arrivesAt[2] = { 0, 0 };
+};
+
+class OSAP_Gateway_SimLink : public LGateway {
+  public:
+    OSAP_Gateway_SimLink(OSAP_SimLinkWire* _wire, uint8_t _side);
+    void begin(void) override;
+    void loop(void) override;
+    boolean clearToSend(void) override;
+    boolean isOpen(void) override;
+    void send(uint8_t* data, size_t len) override;
+    // both ends are the same build, so the wire carries whole packets 
+    uint16_t getMTU(void) override;
+    #ifdef OSAP_CONFIG_INCLUDE_LINK_COALESCING
+    // as on the usb-serial link, 
+    void setCoalescing(uint32_t windowMicros);
+    LinkCoalescer coalescer;
+    #endif 
+  private:
+    OSAP_SimLinkWire* wire;
+    uint8_t side;
+};
+
+#endif 
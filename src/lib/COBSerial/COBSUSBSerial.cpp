@@ -33,14 +33,36 @@ void COBSUSBSerial::loop(void){
       // decoding in place should always work: COBS doesn't revisit bytes 
       // encoding in place would be a different trick, and would require the use of 
       // nanocobs from this lad: https://github.com/charlesnicholson/nanocobs 
-      size_t len = cobsDecode(rxBuffer, 255, rxBuffer);
-      // now we are with-packet, set length and reset write pointer 
-      // len includes the trailing 0, rm that... 
+      size_t len = cobsDecode(rxBuffer, rxBufferWp, rxBuffer);
+      rxBufferWp = 0;
+      // len includes the trailing 0, rm that... and drop empties & oversize frames, 
+      if(len < 2 || len - 1 > OSAP_CONFIG_LINK_MAX_MTU) continue;
+      if(rxBuffer[0] == LINK_CTRL_KEY){
+        // ours, not the network's, 
+        onControlFrame(rxBuffer, len - 1);
+        continue;
+      }
+      // now we are with-packet, set length 
       rxBufferLen = len - 1; 
+    } else if(rxBufferWp >= sizeof(rxBuffer)){
+      // a frame w/o a delimiter in sight: drop it, the next zero re-syncs us 
       rxBufferWp = 0;
     }
   }
 
+  // link housekeeping goes out when the line is clear, 
+  if(txBufferLen == 0){
+    if(mtuReplyOwed){
+      mtuReplyOwed = false;
+      sendControl(LINK_CTRL_MTU_REPLY);
+    } else if(!mtuReplied && mtuAdvertsSent < OSAP_CONFIG_LINK_MTU_ADVERT_TRIES && 
+              (mtuAdvertsSent == 0 || millis() - mtuLastAdvert >= OSAP_CONFIG_LINK_MTU_ADVERT_MS)){
+      mtuAdvertsSent ++;
+      mtuLastAdvert = millis();
+      sendControl(LINK_CTRL_MTU_ADVERT);
+    }
+  }
+
   // check tx side, 
   while(txBufferLen && usbcdc->availableForWrite()){
     // ship a byte, 
@@ -53,6 +75,36 @@ void COBSUSBSerial::loop(void){
   }
 }
 
+void COBSUSBSerial::onControlFrame(uint8_t* frame, size_t len){
+  if(len < 4) return;
+  switch(frame[1]){
+    case LINK_CTRL_MTU_ADVERT:
+      // they've (re)started, and will want ours, 
+      mtuReplyOwed = true;
+      // fallthrough 
+    case LINK_CTRL_MTU_REPLY:
+      {
+        // we can each send the smaller of the two, 
+        uint16_t theirs = frame[2] | (frame[3] << 8);
+        mtu = (theirs < OSAP_CONFIG_LINK_MAX_MTU) ? theirs : OSAP_CONFIG_LINK_MAX_MTU;
+        mtuReplied = true;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void COBSUSBSerial::sendControl(uint8_t type){
+  uint8_t frame[4] = { LINK_CTRL_KEY, type, 
+    (uint8_t)(OSAP_CONFIG_LINK_MAX_MTU & 255), (uint8_t)(OSAP_CONFIG_LINK_MAX_MTU >> 8) };
+  send(frame, 4);
+}
+
+uint16_t COBSUSBSerial::getMTU(void){
+  return mtu;
+}
+
 size_t COBSUSBSerial::getPacket(uint8_t* dest){
   if(rxBufferLen > 0){
     memcpy(dest, rxBuffer, rxBufferLen);
@@ -69,15 +121,15 @@ boolean COBSUSBSerial::clearToRead(void){
 }
 
 void COBSUSBSerial::send(uint8_t* packet, size_t len){  
-  // we have a max: we need to stuff into 255, 
-  // and we have a trailing zero and the first key 
-  if(len > 253) len = 253;
+  // we have a max: whatever we've agreed w/ the other end, 
+  if(len > mtu) len = mtu;
+  // and we queue behind whatever is still going out, if it fits, 
+  if(txBufferLen + COBS_ENCODED_SIZE(len) > sizeof(txBuffer)) return;
   // ship that, 
-  size_t encodedLen = cobsEncode(packet, len, txBuffer);
+  size_t encodedLen = cobsEncode(packet, len, &(txBuffer[txBufferLen]));
   // stuff 0 byte, 
-  txBuffer[encodedLen] = 0;
-  txBufferLen = encodedLen + 1;
-  txBufferRp = 0;
+  txBuffer[txBufferLen + encodedLen] = 0;
+  txBufferLen += encodedLen + 1;
 }
 
 boolean COBSUSBSerial::clearToSend(void){
@@ -1,6 +1,17 @@
 // example cobs-encoded usb-serial link 
 
 #include <Arduino.h>
+#include "../../osap_config.h"
+
+// COBS adds one code byte per 254 bytes (and one up front), plus the delimiter, 
+#define COBS_ENCODED_SIZE(len) ((len) + ((len) / 254) + 2)
+
+// frames that start w/ this are for the link itself, not the network: 
+// packets always start w/ their PTR (>= 5) and batches w/ a 0, 
+// | LINK_CTRL_KEY | LINK_CTRL_MTU_ADVERT or _REPLY | MTU:2 | 
+#define LINK_CTRL_KEY 1 
+#define LINK_CTRL_MTU_ADVERT 1 
+#define LINK_CTRL_MTU_REPLY 2 
 
 class COBSUSBSerial {
   public: 
@@ -20,8 +31,12 @@ class COBSUSBSerial {
     boolean clearToSend(void);
     // open at all?
     boolean isOpen(void);
-    // transmit a packet of this length 
+    // transmit a packet of this length, frames sent while the last one is still 
+    // going out are queued behind it if there's space, else dropped 
     void send(uint8_t* packet, size_t len);
+    // the largest frame we can send, starts at OSAP_CONFIG_LINK_DEFAULT_MTU 
+    // and is raised once the peer tells us theirs, 
+    uint16_t getMTU(void);
   private: 
     #if defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_RP2040)
     SerialUSB* usbcdc = nullptr;
@@ -31,11 +46,23 @@ class COBSUSBSerial {
     Serial_* usbcdc = nullptr;
     #endif 
     // buffer, write pointer, length, 
-    uint8_t rxBuffer[255];
-    uint8_t rxBufferWp = 0;
-    uint8_t rxBufferLen = 0;
-    // ibid, 
-    uint8_t txBuffer[255];
-    uint8_t txBufferRp = 0;
-    uint8_t txBufferLen = 0;
+    uint8_t rxBuffer[COBS_ENCODED_SIZE(OSAP_CONFIG_LINK_MAX_MTU)];
+    uint16_t rxBufferWp = 0;
+    uint16_t rxBufferLen = 0;
+    // ibid, w/ room for a coalesced batch queued behind a full frame, 
+    #ifdef OSAP_CONFIG_INCLUDE_LINK_COALESCING
+    uint8_t txBuffer[COBS_ENCODED_SIZE(OSAP_CONFIG_LINK_MAX_MTU) + COBS_ENCODED_SIZE(OSAP_CONFIG_LINK_COALESCE_MAX_FRAME)];
+    #else 
+    uint8_t txBuffer[COBS_ENCODED_SIZE(OSAP_CONFIG_LINK_MAX_MTU)];
+    #endif 
+    uint16_t txBufferRp = 0;
+    uint16_t txBufferLen = 0;
+    // mtu negotiation, 
+    uint16_t mtu = OSAP_CONFIG_LINK_DEFAULT_MTU;
+    boolean mtuReplied = false;
+    boolean mtuReplyOwed = false;
+    uint8_t mtuAdvertsSent = 0;
+    uint32_t mtuLastAdvert = 0;
+    void onControlFrame(uint8_t* frame, size_t len);
+    void sendControl(uint8_t type);
 };
\ No newline at end of file
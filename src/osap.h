@@ -19,10 +19,14 @@ is; no warranty is provided, and users accept all liability.
 // components we are going to present at a "high level" 
 
 #include "runtime/runtime.h"
+#include "runtime/traversal.h"
+#include "runtime/coroutines.h"
 #include "utils/debug.h"
 
 // we could also do config-dependent include of various links...
 #include "gateway_integrations/link_cobsUsbSerial.h"
+#include "gateway_integrations/bus_simulated.h"
+#include "gateway_integrations/link_simulated.h"
 
 // and of port types...
 #include "port_integrations/port_named.h"
@@ -30,5 +34,9 @@ is; no warranty is provided, and users accept all liability.
 #include "port_integrations/port_messageEscape.h"
 #include "port_integrations/port_onePipe.h"
 #include "port_integrations/port_rpc.h"
+#include "port_integrations/port_rpc_dispatch.h"
+#include "port_integrations/port_trace.h"
+#include "port_integrations/port_reliable.h"
+#include "port_integrations/port_coroutine.h"
 
 #endif
@@ -23,37 +23,382 @@ no warranty is provided, and users accept all liability.
 // MINOR: 2
 
 #define OSAP_VERSION_MAJOR 0 
-#define OSAP_VERSION_MID 5
+#define OSAP_VERSION_MID 7
 #define OSAP_VERSION_MINOR 0
 
+// runtimes at or above this version understand the short (v2) route keys, 
+// TKEY_LINKF_S and TKEY_PORTPACK_S, so routes through them may use those 
+#define OSAP_VERSION_SHORT_KEYS_MID 6
+
+// and these report links as | TYPE | OPEN | MTU:2 | in LGATEWAYINFO and DISCOVER replies, 
+// where older runtimes report | TYPE | OPEN | 
+#define OSAP_VERSION_LINK_MTU_MID 7
+
+// and these report the instruction they were entered on (the route's last) as the 
+// ENTRY in RUNTIMEINFO, where older runtimes report the route's first 
+#define OSAP_VERSION_LAST_ENTRY_MID 7
+
+// -------------------------------- Overrides 
+
+// every value below can be set ahead of this file, so that one firmware can build 
+// for a D11 and a Teensy w/o edits to the library: either w/ build flags (-D, i.e. 
+// platformio's build_flags), or in an `osap_user_config.h` anywhere on the include path 
+// (arduino builds libraries apart from the sketch, so that's i.e. a tiny library of its own) 
+#if defined(__has_include)
+#if __has_include(<osap_user_config.h>)
+#include <osap_user_config.h>
+#endif 
+#endif 
+
 // -------------------------------- Stack / Build Sizes
 
-// TODO: we have from i.e. COBSUSBSerial.cpp examples of `if defined(ARDUINO_ARCH...)
-// - we should use those to set relative stack sizes for typical RAM avail
-// and should also watch out to perhaps set compiler flags for RP2040 to allocate 
-// these buffers in RAM rather than slow-af SRAM  
+// capacities default by part, for typical RAM avail: 
+// tier 0: ~ 4kB (D11, AVRs), tier 1: 32kB and up (D21, D51, ...), tier 2: 264kB+ (RP2040, Teensy 4.x) 
+// TODO: perhaps set compiler flags for RP2040 to allocate these buffers in RAM rather than slow-af SRAM  
+#ifndef OSAP_CONFIG_SIZE_TIER
+#if defined(__SAMD11C14A__) || defined(__SAMD11D14AM__) || defined(__SAMD11D14AS__) || defined(ARDUINO_ARCH_AVR)
+#define OSAP_CONFIG_SIZE_TIER 0
+#elif defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_TEENSY41) || defined(ARDUINO_TEENSY40)
+#define OSAP_CONFIG_SIZE_TIER 2
+#else 
+#define OSAP_CONFIG_SIZE_TIER 1
+#endif 
+#endif 
+
+#if OSAP_CONFIG_SIZE_TIER == 0
+  // just-enough for an endpoint w/ one or two links, 
+  #ifndef OSAP_CONFIG_STACK_SIZE
+  #define OSAP_CONFIG_STACK_SIZE 3
+  #endif 
+  #ifndef OSAP_CONFIG_PACKET_MAX_SIZE
+  #define OSAP_CONFIG_PACKET_MAX_SIZE 128
+  #endif 
+  // and our links can't take a full COBS frame before they've negotiated, 
+  #ifndef OSAP_CONFIG_LINK_DEFAULT_MTU
+  #define OSAP_CONFIG_LINK_DEFAULT_MTU 128
+  #endif 
+  #ifndef OSAP_CONFIG_MAX_PORTS
+  #define OSAP_CONFIG_MAX_PORTS 8
+  #endif 
+  #ifndef OSAP_CONFIG_MAX_LGATEWAYS
+  #define OSAP_CONFIG_MAX_LGATEWAYS 2
+  #endif 
+  #ifndef OSAP_CONFIG_MAX_BGATEWAYS
+  #define OSAP_CONFIG_MAX_BGATEWAYS 1
+  #endif 
+  #ifndef OSAP_CONFIG_ROUTE_MAX_LENGTH
+  #define OSAP_CONFIG_ROUTE_MAX_LENGTH 32
+  #endif 
+  #ifndef OSAP_CONFIG_LOG_LENGTH
+  #define OSAP_CONFIG_LOG_LENGTH 8
+  #endif 
+  #ifndef OSAP_CONFIG_RPC_PENDING_SLOTS
+  #define OSAP_CONFIG_RPC_PENDING_SLOTS 2
+  #endif 
+  #ifndef OSAP_CONFIG_COROUTINE_SLOTS
+  #define OSAP_CONFIG_COROUTINE_SLOTS 2
+  #endif 
+  #ifndef OSAP_CONFIG_SUBSCRIPTION_SLOTS
+  #define OSAP_CONFIG_SUBSCRIPTION_SLOTS 2
+  #endif 
+  #ifndef OSAP_CONFIG_ONEPIPE_RING_SIZE
+  #define OSAP_CONFIG_ONEPIPE_RING_SIZE 128
+  #endif 
+  #ifndef OSAP_CONFIG_ONEPIPE_MAX_SUBSCRIBERS
+  #define OSAP_CONFIG_ONEPIPE_MAX_SUBSCRIBERS 2
+  #endif 
+  #ifndef OSAP_CONFIG_RELIABLE_WINDOW
+  #define OSAP_CONFIG_RELIABLE_WINDOW 2
+  #endif 
+  #ifndef OSAP_CONFIG_RELIABLE_MAX_PAYLOAD
+  #define OSAP_CONFIG_RELIABLE_MAX_PAYLOAD 64
+  #endif 
+  #ifndef OSAP_CONFIG_COROUTINE_FRAME_SIZE
+  #define OSAP_CONFIG_COROUTINE_FRAME_SIZE 128
+  #endif 
+  // and coalescing's two frames per link are too much, 
+  #ifndef OSAP_CONFIG_EXCLUDE_LINK_COALESCING
+  #define OSAP_CONFIG_EXCLUDE_LINK_COALESCING
+  #endif 
+#elif OSAP_CONFIG_SIZE_TIER == 2
+  // parts w/ RAM to spare carry larger segments, to amortize headers and USB overhead, 
+  #ifndef OSAP_CONFIG_STACK_SIZE
+  #define OSAP_CONFIG_STACK_SIZE 16
+  #endif 
+  #ifndef OSAP_CONFIG_PACKET_MAX_SIZE
+  #define OSAP_CONFIG_PACKET_MAX_SIZE 1024
+  #endif 
+  #ifndef OSAP_CONFIG_ONEPIPE_RING_SIZE
+  #define OSAP_CONFIG_ONEPIPE_RING_SIZE 4096
+  #endif 
+  #ifndef OSAP_CONFIG_RELIABLE_WINDOW
+  #define OSAP_CONFIG_RELIABLE_WINDOW 16
+  #endif 
+  #ifndef OSAP_CONFIG_RELIABLE_MAX_PAYLOAD
+  #define OSAP_CONFIG_RELIABLE_MAX_PAYLOAD 512
+  #endif 
+#endif 
 
+// and everything else, 
+#ifndef OSAP_CONFIG_STACK_SIZE
 #define OSAP_CONFIG_STACK_SIZE 6
+#endif 
+#ifndef OSAP_CONFIG_PACKET_MAX_SIZE
 #define OSAP_CONFIG_PACKET_MAX_SIZE 256
+#endif 
 
+#ifndef OSAP_CONFIG_MAX_PORTS
 #define OSAP_CONFIG_MAX_PORTS 32
+#endif 
+// links' open-states are tracked in a uint32_t, so 32 at most 
+#ifndef OSAP_CONFIG_MAX_LGATEWAYS
 #define OSAP_CONFIG_MAX_LGATEWAYS 16
+#endif 
+#ifndef OSAP_CONFIG_MAX_BGATEWAYS
 #define OSAP_CONFIG_MAX_BGATEWAYS 8
+#endif 
 
+#ifndef OSAP_CONFIG_ROUTE_MAX_LENGTH
 #define OSAP_CONFIG_ROUTE_MAX_LENGTH 64 
+#endif 
+
+// -------------------------------- Link MTUs 
+
+// links carry this much per frame until they've negotiated w/ their peer, 
+// (the original COBS framing: 255 bytes, less the code byte and the delimiter) 
+#ifndef OSAP_CONFIG_LINK_DEFAULT_MTU
+#define OSAP_CONFIG_LINK_DEFAULT_MTU 253
+#endif 
+// and we offer up to this much, links buffer (a little over) this much in each direction 
+#ifndef OSAP_CONFIG_LINK_MAX_MTU
+#define OSAP_CONFIG_LINK_MAX_MTU OSAP_CONFIG_PACKET_MAX_SIZE
+#endif 
+// (i.e. tiers or overrides w/ packets smaller than 253 bytes need a smaller default as well) 
+static_assert(OSAP_CONFIG_LINK_DEFAULT_MTU <= OSAP_CONFIG_LINK_MAX_MTU, "OSAP_CONFIG_LINK_DEFAULT_MTU must be no larger than OSAP_CONFIG_LINK_MAX_MTU");
+// we advertise our MTU on startup, this often, this many times, or until the peer replies 
+#ifndef OSAP_CONFIG_LINK_MTU_ADVERT_MS
+#define OSAP_CONFIG_LINK_MTU_ADVERT_MS 250
+#endif 
+#ifndef OSAP_CONFIG_LINK_MTU_ADVERT_TRIES
+#define OSAP_CONFIG_LINK_MTU_ADVERT_TRIES 8
+#endif 
+
+// -------------------------------- Link Coalescing (see gateway_integrations/link_coalesce.h) 
+
+// lets link gateways pack small packets into shared frames, once .setCoalescing() is called, 
+// costs two frames of RAM per link, so it's off on the smallest parts (define _EXCLUDE_ to drop it) 
+#ifndef OSAP_CONFIG_EXCLUDE_LINK_COALESCING
+#define OSAP_CONFIG_INCLUDE_LINK_COALESCING
+#endif 
+
+#ifdef OSAP_CONFIG_INCLUDE_LINK_COALESCING
+// the largest frame we'll build, COBS links carry 253 bytes per frame 
+#ifndef OSAP_CONFIG_LINK_COALESCE_MAX_FRAME
+#define OSAP_CONFIG_LINK_COALESCE_MAX_FRAME 253
+#endif 
+#endif 
+
+// -------------------------------- Fragmentation (see packets/fragments.h) 
+
+// ports sending / receiving large messages at once, 
+#ifndef OSAP_CONFIG_FRAG_TX_SLOTS
+#define OSAP_CONFIG_FRAG_TX_SLOTS 2
+#endif 
+#ifndef OSAP_CONFIG_FRAG_RX_SLOTS
+#define OSAP_CONFIG_FRAG_RX_SLOTS 2
+#endif 
+// pieces per message, at ~ 230 bytes apiece 
+#ifndef OSAP_CONFIG_FRAG_MAX_FRAGMENTS
+#define OSAP_CONFIG_FRAG_MAX_FRAGMENTS 128
+#endif 
+// a half-received message is abandoned after this long w/o a fragment, 
+#ifndef OSAP_CONFIG_FRAG_TIMEOUT_MS
+#define OSAP_CONFIG_FRAG_TIMEOUT_MS 500
+#endif 
+
+// -------------------------------- Async RPC (see runtime/rpc_pending.h) 
+
+// calls that complete later, each one holds a reverse route until it does, 
+#ifndef OSAP_CONFIG_RPC_PENDING_SLOTS
+#define OSAP_CONFIG_RPC_PENDING_SLOTS 4
+#endif 
+// and is abandoned after this long, 
+#ifndef OSAP_CONFIG_RPC_PENDING_TIMEOUT_MS
+#define OSAP_CONFIG_RPC_PENDING_TIMEOUT_MS 2000
+#endif 
+
+// -------------------------------- Subscriptions (see runtime/subscriptions.h) 
+
+// streams at once, each one holds a reverse route and its args, 
+#ifndef OSAP_CONFIG_SUBSCRIPTION_SLOTS
+#define OSAP_CONFIG_SUBSCRIPTION_SLOTS 4
+#endif 
+// the most arg bytes a subscription can carry, 
+#ifndef OSAP_CONFIG_SUBSCRIPTION_MAX_ARGS
+#define OSAP_CONFIG_SUBSCRIPTION_MAX_ARGS 16
+#endif 
+
+// -------------------------------- OnePipe (see port_integrations/port_onePipe.h) 
+
+// bytes of samples each pipe buffers while its port isn't clear, (each sample costs one more) 
+#ifndef OSAP_CONFIG_ONEPIPE_RING_SIZE
+#define OSAP_CONFIG_ONEPIPE_RING_SIZE 1024
+#endif 
+// listeners per pipe, each one holds a reverse route, 
+#ifndef OSAP_CONFIG_ONEPIPE_MAX_SUBSCRIBERS
+#define OSAP_CONFIG_ONEPIPE_MAX_SUBSCRIBERS 4
+#endif 
+
+// -------------------------------- Reliable Streams (see port_integrations/port_reliable.h) 
+
+// packets in flight per stream, each end buffers this many (of _MAX_PAYLOAD bytes) 
+#ifndef OSAP_CONFIG_RELIABLE_WINDOW
+#define OSAP_CONFIG_RELIABLE_WINDOW 8
+#endif 
+#ifndef OSAP_CONFIG_RELIABLE_MAX_PAYLOAD
+#define OSAP_CONFIG_RELIABLE_MAX_PAYLOAD 128
+#endif 
+// the retransmit timeout adapts to measured round trips, between these, 
+#ifndef OSAP_CONFIG_RELIABLE_RTO_INITIAL_MS
+#define OSAP_CONFIG_RELIABLE_RTO_INITIAL_MS 250
+#endif 
+#ifndef OSAP_CONFIG_RELIABLE_RTO_MIN_MS
+#define OSAP_CONFIG_RELIABLE_RTO_MIN_MS 10
+#endif 
+#ifndef OSAP_CONFIG_RELIABLE_RTO_MAX_MS
+#define OSAP_CONFIG_RELIABLE_RTO_MAX_MS 2000
+#endif 
+// and a stream is given up on after this many tries at one packet, 
+#ifndef OSAP_CONFIG_RELIABLE_MAX_TRIES
+#define OSAP_CONFIG_RELIABLE_MAX_TRIES 8
+#endif 
+
+// -------------------------------- Coroutines (see runtime/coroutines.h) 
+
+// on wherever the compiler has them (C++20), define OSAP_CONFIG_EXCLUDE_COROUTINES to drop them, 
+#if defined(__cpp_impl_coroutine) && !defined(OSAP_CONFIG_EXCLUDE_COROUTINES)
+#define OSAP_CONFIG_INCLUDE_COROUTINES
+#endif 
+// tasks at once, each one's frame comes from a fixed pool of these, 
+#ifndef OSAP_CONFIG_COROUTINE_SLOTS
+#define OSAP_CONFIG_COROUTINE_SLOTS 4
+#endif 
+// bytes per frame: a task's locals live here, so keep big buffers out of them, 
+#ifndef OSAP_CONFIG_COROUTINE_FRAME_SIZE
+#define OSAP_CONFIG_COROUTINE_FRAME_SIZE 384
+#endif 
+// replies to co_await'ed requests, 
+#ifndef OSAP_CONFIG_COROUTINE_REQUEST_TIMEOUT_MS
+#define OSAP_CONFIG_COROUTINE_REQUEST_TIMEOUT_MS 1000
+#endif 
+
+// -------------------------------- Route IDs (see packets/route_ids.h) 
+
+// uncomment (or define ahead, see Overrides) to let interned routes travel as a 2-byte label instead of a full path, 
+// #define OSAP_CONFIG_INCLUDE_ROUTE_IDS
+
+#ifdef OSAP_CONFIG_INCLUDE_ROUTE_IDS
+// entries per runtime (255 at most), each one holds a reverse path for delivery, 
+#ifndef OSAP_CONFIG_ROUTEID_TABLE_SIZE
+#define OSAP_CONFIG_ROUTEID_TABLE_SIZE 16
+#endif 
+// senders re-install their routes this often, in case a hop has evicted them 
+#ifndef OSAP_CONFIG_ROUTEID_REFRESH_MS
+#define OSAP_CONFIG_ROUTEID_REFRESH_MS 1000
+#endif 
+#endif 
+
+// -------------------------------- Embedded Traversal (see runtime/traversal.h) 
+
+// only allocated if an OSAP_Traversal is instantiated, 
+#ifndef OSAP_CONFIG_TRAVERSAL_MAX_NODES
+#define OSAP_CONFIG_TRAVERSAL_MAX_NODES 32
+#endif 
+#ifndef OSAP_CONFIG_TRAVERSAL_MAX_PORTS
+#define OSAP_CONFIG_TRAVERSAL_MAX_PORTS 64
+#endif 
+#ifndef OSAP_CONFIG_TRAVERSAL_MAX_DEPTH
+#define OSAP_CONFIG_TRAVERSAL_MAX_DEPTH 8
+#endif 
+#ifndef OSAP_CONFIG_TRAVERSAL_MAX_GATEWAYS
+#define OSAP_CONFIG_TRAVERSAL_MAX_GATEWAYS 64
+#endif 
+#ifndef OSAP_CONFIG_TRAVERSAL_NAME_POOL
+#define OSAP_CONFIG_TRAVERSAL_NAME_POOL 512
+#endif 
+#ifndef OSAP_CONFIG_TRAVERSAL_MAX_IN_FLIGHT
+#define OSAP_CONFIG_TRAVERSAL_MAX_IN_FLIGHT 4
+#endif 
+#ifndef OSAP_CONFIG_TRAVERSAL_TIMEOUT_MS
+#define OSAP_CONFIG_TRAVERSAL_TIMEOUT_MS 500
+#endif 
+#ifndef OSAP_CONFIG_TRAVERSAL_RETRIES
+#define OSAP_CONFIG_TRAVERSAL_RETRIES 2
+#endif 
 
 // -------------------------------- Error / Debug Build Options 
 
+// on by default, define OSAP_CONFIG_EXCLUDE_DEBUG_MSGS / _ERROR_MSGS to drop them, 
+#ifndef OSAP_CONFIG_EXCLUDE_DEBUG_MSGS
 #define OSAP_CONFIG_INCLUDE_DEBUG_MSGS
+#endif 
+#ifndef OSAP_CONFIG_EXCLUDE_ERROR_MSGS
 #define OSAP_CONFIG_INCLUDE_ERROR_MSGS
+#endif 
+
+// internal errors are written as codes into a ring (see utils/log.h), 
+// length in records (8 bytes each), must be a power of two 
+#ifndef OSAP_CONFIG_LOG_LENGTH
+#define OSAP_CONFIG_LOG_LENGTH 32
+#endif 
+// and are rate limited: at most _BURST at once, regaining one every _REFILL_MS 
+#ifndef OSAP_CONFIG_LOG_BURST
+#define OSAP_CONFIG_LOG_BURST 8
+#endif 
+#ifndef OSAP_CONFIG_LOG_REFILL_MS
+#define OSAP_CONFIG_LOG_REFILL_MS 10
+#endif 
+
+// -------------------------------- Hot-Path Tracing 
+
+// uncomment (or define ahead) to record binary events into a RAM ring, see utils/trace.h, 
+// and add an OSAP_Port_Trace to dump it 
+// #define OSAP_CONFIG_INCLUDE_TRACE
+// ring length in events (8 bytes each), must be a power of two 
+#ifndef OSAP_CONFIG_TRACE_LENGTH
+#define OSAP_CONFIG_TRACE_LENGTH 256
+#endif 
+// on parts w/ a DWT (M3, M4, M7), stamp w/ cycles instead of micros() 
+// #define OSAP_CONFIG_TRACE_USE_DWT
 
 // -------------------------------- Bus-Inclusion or-not, 
 
+// on by default, define OSAP_CONFIG_EXCLUDE_BUS_CODES to drop them, 
+#ifndef OSAP_CONFIG_EXCLUDE_BUS_CODES
 #define OSAP_CONFIG_INCLUDE_BUS_CODES
+#endif 
 
 #ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
 // count of broadcast channels width,
+#ifndef OSAP_BUSCONFIG_MAX_BROADCAST_CHANNELS
 #define OSAP_BUSCONFIG_MAX_BROADCAST_CHANNELS 32
 #endif 
+// count of addresses we report open / closed states for in TKEY_BGATEWAYINFO_RES 
+#ifndef OSAP_BUSCONFIG_MAX_ADDRESSES
+#define OSAP_BUSCONFIG_MAX_ADDRESSES 32
+#endif 
+// time-slotted busses (see structure/bus_tdma.h): max drops w/ a slot, 
+// default slot width (the head's setting is adopted by all drops), 
+// and how many silent cycles before a slot is reclaimed 
+#ifndef OSAP_BUSCONFIG_TDMA_MAX_SLOTS
+#define OSAP_BUSCONFIG_TDMA_MAX_SLOTS 16
+#endif 
+#ifndef OSAP_BUSCONFIG_TDMA_SLOT_WIDTH_US
+#define OSAP_BUSCONFIG_TDMA_SLOT_WIDTH_US 500
+#endif 
+#ifndef OSAP_BUSCONFIG_TDMA_RECLAIM_CYCLES
+#define OSAP_BUSCONFIG_TDMA_RECLAIM_CYCLES 8
+#endif 
+#endif 
 
 #endif
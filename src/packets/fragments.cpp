@@ -0,0 +1,198 @@
+/*
+osap/fragments.cpp
+
+port-to-port messages larger than one segment 
+
+Jake Read at the Center for Bits and Atoms
+(c) Massachusetts Institute of Technology 2022
+
+This work may be reproduced, modified, distributed, performed, and
+displayed for any purpose, but must acknowledge the osap project.
+Copyright is retained and must be preserved. The work is provided as is;
+no warranty is provided, and users accept all liability.
+*/
+
+#include "fragments.h"
+#include "packets.h"
+#include "../structure/ports.h"
+#include "../utils/keys.h"
+#include "../utils/serializers.h"
+#include "../utils/log.h"
+#include "../runtime/runtime.h"
+
+FragmentTx fragmentTxSlots[OSAP_CONFIG_FRAG_TX_SLOTS];
+FragmentRx fragmentRxSlots[OSAP_CONFIG_FRAG_RX_SLOTS];
+uint8_t fragmentNextMsgID = 0;
+
+// ---------------------------------------------- Senders 
+
+boolean fragmentsSend(VPort* vport, uint16_t sourcePort, uint8_t* data, size_t len, Route* route, uint16_t destinationPort){
+  // one at a time per port, 
+  if(fragmentsSending(vport)) return false;
+  // how much fits in each, on the first hop too, 
+  OSAP_Runtime::getInstance()->fitRoute(route);
+  size_t space = route->maxSegmentSize;
+  if(space > OSAP_CONFIG_PACKET_MAX_SIZE) space = OSAP_CONFIG_PACKET_MAX_SIZE;
+  if(space <= (size_t)(5 + route->encodedPathLen + FRAG_HEADER_LEN)) return false;
+  uint16_t fragSize = space - 5 - route->encodedPathLen - FRAG_HEADER_LEN;
+  uint32_t count = (len + fragSize - 1) / fragSize;
+  if(count == 0 || count > OSAP_CONFIG_FRAG_MAX_FRAGMENTS){
+    OSAP_LOG(LOGCODE_FRAG_TOO_LARGE, count);
+    return false;
+  }
+  // a free slot, 
+  for(uint8_t s = 0; s < OSAP_CONFIG_FRAG_TX_SLOTS; s ++){
+    FragmentTx* tx = &(fragmentTxSlots[s]);
+    if(tx->vport != nullptr) continue;
+    tx->vport = vport;
+    tx->data = data;
+    tx->total = len;
+    tx->fragSize = fragSize;
+    tx->nextSeq = 0;
+    tx->count = count;
+    tx->msgID = fragmentNextMsgID ++;
+    tx->route = *route;
+    tx->sourcePort = sourcePort;
+    tx->destinationPort = destinationPort;
+    return true;
+  }
+  return false;
+}
+
+boolean fragmentsSending(VPort* vport){
+  for(uint8_t s = 0; s < OSAP_CONFIG_FRAG_TX_SLOTS; s ++){
+    if(fragmentTxSlots[s].vport == vport) return true;
+  }
+  return false;
+}
+
+void fragmentsLoop(void){
+  for(uint8_t s = 0; s < OSAP_CONFIG_FRAG_TX_SLOTS; s ++){
+    FragmentTx* tx = &(fragmentTxSlots[s]);
+    if(tx->vport == nullptr) continue;
+    // we pipeline: as many as the port may hold, the links' clear-to-send 
+    // is our flow control from there on 
+    while(tx->nextSeq < tx->count && tx->vport->clearToSend()){
+      VPacket* pck = getPacketFromStack(tx->vport);
+      if(pck == nullptr) break;
+      // header, 
+      uint16_t wptr = stuffPacketRoute(pck, &(tx->route));
+      pck->data[wptr ++] = TKEY_PORTFRAG;
+      serializers_writeUint16(pck->data, &wptr, tx->sourcePort);
+      serializers_writeUint16(pck->data, &wptr, tx->destinationPort);
+      pck->data[wptr ++] = tx->msgID;
+      serializers_writeUint16(pck->data, &wptr, tx->nextSeq);
+      serializers_writeUint16(pck->data, &wptr, tx->fragSize);
+      serializers_writeUint32(pck->data, &wptr, tx->total);
+      // and this chunk, 
+      uint32_t offset = (uint32_t)(tx->nextSeq) * tx->fragSize;
+      size_t len = tx->total - offset;
+      if(len > tx->fragSize) len = tx->fragSize;
+      memcpy(&(pck->data[wptr]), &(tx->data[offset]), len);
+      pck->len = wptr + len;
+      tx->nextSeq ++;
+    }
+    // done w/ the caller's buffer, 
+    if(tx->nextSeq >= tx->count) tx->vport = nullptr;
+  }
+  // and give up on messages that have stopped arriving, so the slot is free for the next, 
+  uint32_t now = millis();
+  for(uint8_t s = 0; s < OSAP_CONFIG_FRAG_RX_SLOTS; s ++){
+    FragmentRx* rx = &(fragmentRxSlots[s]);
+    if(rx->active && now - rx->lastRx > OSAP_CONFIG_FRAG_TIMEOUT_MS){
+      OSAP_LOG(LOGCODE_FRAG_TIMEOUT, rx->sourcePort);
+      rx->active = false;
+    }
+  }
+}
+
+// ---------------------------------------------- Receivers 
+
+boolean fragmentsAccept(VPort* vport, uint8_t* buffer, size_t size){
+  for(uint8_t s = 0; s < OSAP_CONFIG_FRAG_RX_SLOTS; s ++){
+    FragmentRx* rx = &(fragmentRxSlots[s]);
+    if(rx->vport != nullptr && rx->vport != vport) continue;
+    rx->vport = vport;
+    rx->buffer = buffer;
+    rx->size = size;
+    rx->active = false;
+    return true;
+  }
+  return false;
+}
+
+FragmentRx* fragmentsIngest(VPort* vport, VPacket* pck){
+  uint16_t ptr = pck->data[0];
+  uint8_t* frag = &(pck->data[ptr]);
+  size_t len = pck->len - ptr;
+  // find our slot, 
+  FragmentRx* rx = nullptr;
+  for(uint8_t s = 0; s < OSAP_CONFIG_FRAG_RX_SLOTS; s ++){
+    if(fragmentRxSlots[s].vport == vport){
+      rx = &(fragmentRxSlots[s]);
+      break;
+    }
+  }
+  if(rx == nullptr || len < FRAG_HEADER_LEN){
+    OSAP_LOG(LOGCODE_FRAG_DROPPED, 0);
+    return nullptr;
+  }
+  // | TKEY_PORTFRAG | src:2 | dst:2 | MSGID | SEQ:2 | FRAGSIZE:2 | TOTAL:4 | 
+  uint16_t sourcePort = serializers_readUint16(frag, 1);
+  uint8_t msgID = frag[5];
+  uint16_t seq = serializers_readUint16(frag, 6);
+  uint16_t fragSize = serializers_readUint16(frag, 8);
+  uint32_t total = serializers_readUint32(frag, 10);
+  uint8_t* bytes = &(frag[FRAG_HEADER_LEN]);
+  len -= FRAG_HEADER_LEN;
+  // port indices are only unique per runtime, so senders are told apart by the path they came on too, 
+  uint16_t routeHash = 5381;
+  for(uint16_t i = 5; i < ptr; i ++) routeHash = routeHash * 33 + pck->data[i];
+  boolean sameSender = (rx->sourcePort == sourcePort && rx->routeHash == routeHash);
+  uint32_t now = millis();
+  // a new message ? we take it if we're idle, or if the last one has gone quiet, 
+  // or if it's the next from the same sender (the last one lost some pieces) 
+  if(!rx->active || rx->msgID != msgID || !sameSender){
+    if(rx->active && !sameSender && now - rx->lastRx < OSAP_CONFIG_FRAG_TIMEOUT_MS){
+      OSAP_LOG(LOGCODE_FRAG_DROPPED, sourcePort);
+      return nullptr;
+    }
+    if(fragSize == 0 || total > rx->size){
+      OSAP_LOG(LOGCODE_FRAG_DROPPED, sourcePort);
+      return nullptr;
+    }
+    uint32_t count = (total + fragSize - 1) / fragSize;
+    if(count == 0 || count > OSAP_CONFIG_FRAG_MAX_FRAGMENTS){
+      OSAP_LOG(LOGCODE_FRAG_DROPPED, sourcePort);
+      return nullptr;
+    }
+    rx->active = true;
+    rx->sourcePort = sourcePort;
+    rx->routeHash = routeHash;
+    rx->msgID = msgID;
+    rx->total = total;
+    rx->fragSize = fragSize;
+    rx->count = count;
+    rx->received = 0;
+    memset(rx->bitmap, 0, sizeof(rx->bitmap));
+  }
+  rx->lastRx = now;
+  // check it fits where it says it goes, 
+  uint32_t offset = (uint32_t)seq * rx->fragSize;
+  if(seq >= rx->count || fragSize != rx->fragSize || offset + len > rx->total){
+    OSAP_LOG(LOGCODE_FRAG_DROPPED, sourcePort);
+    return nullptr;
+  }
+  // and not a repeat, 
+  uint8_t bit = 1 << (seq & 7);
+  if(rx->bitmap[seq >> 3] & bit) return nullptr;
+  rx->bitmap[seq >> 3] |= bit;
+  memcpy(&(rx->buffer[offset]), bytes, len);
+  rx->received ++;
+  // whole ? 
+  if(rx->received == rx->count){
+    rx->active = false;
+    return rx;
+  }
+  return nullptr;
+}
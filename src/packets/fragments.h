@@ -0,0 +1,83 @@
+/*
+osap/fragments.h
+
+port-to-port messages larger than one segment 
+
+Jake Read at the Center for Bits and Atoms
+(c) Massachusetts Institute of Technology 2022
+
+This work may be reproduced, modified, distributed, performed, and
+displayed for any purpose, but must acknowledge the osap project.
+Copyright is retained and must be preserved. The work is provided as is;
+no warranty is provided, and users accept all liability.
+*/
+
+#ifndef OSAP_FRAGMENTS_H_
+#define OSAP_FRAGMENTS_H_
+
+#include <Arduino.h>
+#include "routes.h"
+
+class VPort;
+struct VPacket;
+
+// large messages go as a train of 
+// | TKEY_PORTFRAG | src:2 | dst:2 | MSGID | SEQ:2 | FRAGSIZE:2 | TOTAL:4 | bytes | 
+// where every fragment but the last is FRAGSIZE long, so the receiver can place 
+// fragments at SEQ * FRAGSIZE in any order, and count them off in a bitmap 
+#define FRAG_HEADER_LEN 14 
+
+// ---------------------------------------------- Senders 
+
+typedef struct FragmentTx {
+  VPort* vport = nullptr;
+  // the caller's buffer, which has to stay put until we're done w/ it, 
+  uint8_t* data = nullptr;
+  uint32_t total = 0;
+  uint16_t fragSize = 0;
+  uint16_t nextSeq = 0;
+  uint16_t count = 0;
+  uint8_t msgID = 0;
+  Route route;
+  uint16_t sourcePort = 0;
+  uint16_t destinationPort = 0;
+} FragmentTx;
+
+// claims a tx slot for this port, returns false if there isn't one or the message won't fit 
+boolean fragmentsSend(VPort* vport, uint16_t sourcePort, uint8_t* data, size_t len, Route* route, uint16_t destinationPort);
+// true while a port has fragments yet to go out, 
+boolean fragmentsSending(VPort* vport);
+
+// ---------------------------------------------- Receivers 
+
+typedef struct FragmentRx {
+  VPort* vport = nullptr;
+  // the port's buffer, 
+  uint8_t* buffer = nullptr;
+  size_t size = 0;
+  // the message underway, 
+  boolean active = false;
+  uint16_t sourcePort = 0;
+  // a hash of the path it's arriving on, 
+  uint16_t routeHash = 0;
+  uint8_t msgID = 0;
+  uint32_t total = 0;
+  uint16_t fragSize = 0;
+  uint16_t count = 0;
+  uint16_t received = 0;
+  uint8_t bitmap[(OSAP_CONFIG_FRAG_MAX_FRAGMENTS + 7) / 8];
+  uint32_t lastRx = 0;
+} FragmentRx;
+
+// ports opt in to large messages by handing us somewhere to put them, 
+boolean fragmentsAccept(VPort* vport, uint8_t* buffer, size_t size);
+
+// ---------------------------------------------- Runtime-Facing 
+
+// issues whatever fragments we can, and times-out stalled receptions, once per runtime loop 
+void fragmentsLoop(void);
+// ingest one fragment (a packet w/ its pointer at the TKEY_PORTFRAG key), 
+// returns the rx state once the message is whole, or nullptr 
+FragmentRx* fragmentsIngest(VPort* vport, VPacket* pck);
+
+#endif 
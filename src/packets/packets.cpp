@@ -15,20 +15,42 @@ no warranty is provided, and users accept all liability.
 #include "packets.h"
 #include "../utils/serializers.h"
 #include "../utils/keys.h"
-#include "../utils/debug.h"
+#include "../utils/trace.h"
+#include "../utils/log.h"
+#include "route_ids.h"
+#include "../runtime/runtime.h"
 
 // we have some file-scoped pointers, 
 VPacket* queueStart;
 VPacket* firstFree;
+// and the base, so that traces can report slots 
+VPacket* stackBase;
+
+// and counts for stats, 
+size_t stackAllocated = 0;
+size_t stackHighWater = 0;
 
 // ---------------------------------------------- Stack Utilities 
 
+// packets are free when nobody holds 'em, 
+static inline boolean packetIsFree(VPacket* pck){
+  #ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+  return (pck->vport == nullptr && pck->lgateway == nullptr && pck->bgateway == nullptr);
+  #else 
+  return (pck->vport == nullptr && pck->lgateway == nullptr);
+  #endif 
+}
+
 void stackReset(VPacket* stack, size_t stackSize){
+  stackBase = stack;
   // reset each individual, 
   for(uint16_t p = 0; p < stackSize; p ++){
     stack[p].len = 0;
     stack[p].vport = nullptr;
     stack[p].lgateway = nullptr;
+    #ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+    stack[p].bgateway = nullptr;
+    #endif 
     stack[p].serviceDeadline = 0;
   }
   // set next ptrs, forwards pass
@@ -44,6 +66,13 @@ void stackReset(VPacket* stack, size_t stackSize){
   // queueStart element is [0], as is the firstFree, at startup,
   queueStart = &(stack[0]);
   firstFree = &(stack[0]);
+  // and nothing is out, 
+  stackAllocated = 0;
+  stackHighWater = 0;
+}
+
+size_t stackGetHighWaterMark(void){
+  return stackHighWater;
 }
 
 size_t stackGetPacketsToService(VPacket** packets, size_t maxPackets){
@@ -60,8 +89,8 @@ size_t stackGetPacketsToService(VPacket** packets, size_t maxPackets){
     // increment, 
     count ++;
     // check next-fullness, 
-    // (if packet is allocated to a vport or a lgateway they would be linked)
-    if(pck->next->vport == nullptr && pck->next->lgateway == nullptr){
+    // (if packet is allocated to a vport or a gateway they would be linked)
+    if(packetIsFree(pck->next)){
       // if next is empty, this is final count:
       return count;
     } else {
@@ -83,7 +112,7 @@ size_t stackGetPacketsToService(VPacket** packets, size_t maxPackets){
 // but templating in the core-core code might make it hard to port to very-tiny MCUs 
 
 boolean getPacketCheck(VPort* vport){
-  if(firstFree->vport == nullptr && firstFree->lgateway == nullptr && vport->currentPacketHold < vport->maxPacketHold){
+  if(packetIsFree(firstFree) && vport->currentPacketHold < vport->maxPacketHold){
     return true;
   } else {
     return false;
@@ -91,19 +120,32 @@ boolean getPacketCheck(VPort* vport){
 }
 
 boolean getPacketCheck(LGateway* lgateway){
-  if(firstFree->vport == nullptr && firstFree->lgateway == nullptr && lgateway->currentPacketHold < lgateway->maxPacketHold){
+  if(packetIsFree(firstFree) && lgateway->currentPacketHold < lgateway->maxPacketHold){
     return true;
   } else {
     return false;
   }
 }
 
+#ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+boolean getPacketCheck(BGateway* bgateway){
+  if(packetIsFree(firstFree) && bgateway->currentPacketHold < bgateway->maxPacketHold){
+    return true;
+  } else {
+    return false;
+  }
+}
+#endif 
+
 VPacket* getPacketFromStack(VPort* vport){
   if(getPacketCheck(vport)){
     // allocate the firstFree in the queue to the requester, 
     VPacket* pck = firstFree;
     pck->vport = vport;
     vport->currentPacketHold ++;
+    if(vport->currentPacketHold > vport->peakPacketHold) vport->peakPacketHold = vport->currentPacketHold;
+    if(++ stackAllocated > stackHighWater) stackHighWater = stackAllocated;
+    OSAP_TRACE(TRACE_EVT_ALLOC, 0, pck - stackBase);
     // increment, 
     firstFree = firstFree->next;
     // hand it over, 
@@ -118,6 +160,9 @@ VPacket* getPacketFromStack(LGateway* lgateway){
     VPacket* pck = firstFree;
     pck->lgateway = lgateway;
     lgateway->currentPacketHold ++;
+    if(lgateway->currentPacketHold > lgateway->peakPacketHold) lgateway->peakPacketHold = lgateway->currentPacketHold;
+    if(++ stackAllocated > stackHighWater) stackHighWater = stackAllocated;
+    OSAP_TRACE(TRACE_EVT_ALLOC, 1, pck - stackBase);
     // increment, 
     firstFree = firstFree->next;
     // hand it over, 
@@ -127,13 +172,44 @@ VPacket* getPacketFromStack(LGateway* lgateway){
   }
 }
 
+#ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+VPacket* getPacketFromStack(BGateway* bgateway){
+  if(getPacketCheck(bgateway)){
+    VPacket* pck = firstFree;
+    pck->bgateway = bgateway;
+    bgateway->currentPacketHold ++;
+    if(bgateway->currentPacketHold > bgateway->peakPacketHold) bgateway->peakPacketHold = bgateway->currentPacketHold;
+    if(++ stackAllocated > stackHighWater) stackHighWater = stackAllocated;
+    OSAP_TRACE(TRACE_EVT_ALLOC, 2, pck - stackBase);
+    // increment, 
+    firstFree = firstFree->next;
+    // hand it over, 
+    return pck;
+  } else {
+    return nullptr;
+  }
+}
+#endif 
+
 void relinquishPacketToStack(VPacket* pck){
   // decriment-count per-point maximums 
   if(pck->vport){
     pck->vport->currentPacketHold --;
+    stackAllocated --;
+    OSAP_TRACE(TRACE_EVT_FREE, 0, pck - stackBase);
   } else if (pck->lgateway){
     pck->lgateway->currentPacketHold --;
+    stackAllocated --;
+    OSAP_TRACE(TRACE_EVT_FREE, 1, pck - stackBase);
+  }
+  #ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+  else if (pck->bgateway){
+    pck->bgateway->currentPacketHold --;
+    stackAllocated --;
+    OSAP_TRACE(TRACE_EVT_FREE, 2, pck - stackBase);
   }
+  pck->bgateway = nullptr;
+  #endif 
   // zero the packet out,
   pck->vport = nullptr;
   pck->lgateway = nullptr;
@@ -162,25 +238,48 @@ void relinquishPacketToStack(VPacket* pck){
 
 // ---------------------------------------------- Route Retrieval 
 
+// local ute, the length of the instruction w/ this key, or 0 if it isn't one, 
+static uint8_t routeInstructionInc(uint8_t key){
+  switch(key){
+    case TKEY_LINKF:
+      return TKEY_LINKF_INC;
+    case TKEY_LINKF_S:
+      return TKEY_LINKF_S_INC;
+    case TKEY_BUSF:
+      return TKEY_BUSF_INC;
+    case TKEY_BUSB:
+      return TKEY_BUSB_INC;
+    case TKEY_LINKF_RI:
+      return TKEY_LINKF_RI_INC;
+    default:
+      return 0;
+  }
+}
+
 // local ute, this figures where the last byte in the route is 
 uint16_t routeEndScan(uint8_t* data, size_t maxLen){
   // 1st instruction is at pck[5] since we have | PTR | PHTTL:2 | MSS:2 | 
   uint16_t end = 5;
   while(true){
-    switch(data[end]){
-      case TKEY_LINKF:
-        end += TKEY_LINKF_INC;
-        break;
-      case TKEY_BUSF:
-        end += TKEY_BUSF_INC;
-        break;
-      default:
-        return end;
-    }
+    uint8_t inc = routeInstructionInc(data[end]);
+    if(inc == 0) return end;
+    end += inc;
     if(end > maxLen) return maxLen;
   }
 }
 
+uint16_t routeLastInstruction(uint8_t* data, size_t maxLen){
+  // walk up to the end, keeping the last start we passed, 
+  uint16_t end = routeEndScan(data, maxLen);
+  uint16_t last = 0;
+  uint16_t at = 5;
+  while(at < end){
+    last = at;
+    at += routeInstructionInc(data[at]);
+  }
+  return last;
+}
+
 void getRouteFromPacket(VPacket* pck, Route* route){
   // ttl, segsize come out of the packet head, 
   // | PTR:1 | PHTTL:2 | MSS:2 | 
@@ -197,10 +296,12 @@ void getRouteFromPacket(VPacket* pck, Route* route){
 // ---------------------------------------------- Packet Authorship 
 
 uint16_t stuffPacketRoute(VPacket* pck, Route* route){
+  // no larger than our first hop will carry, 
+  OSAP_Runtime::getInstance()->fitRoute(route);
   // we share these 
   pck->data[0] = 5;
-  // these write use a pointer, 
-  uint16_t wptr = 5;
+  // these write use a pointer, | PTR | PHTTL:2 | MSS:2 | 
+  uint16_t wptr = 1;
   serializers_writeUint16(pck->data, &wptr, route->perHopTimeToLive);
   serializers_writeUint16(pck->data, &wptr, route->maxSegmentSize);  
   // and the route, 
@@ -217,7 +318,7 @@ void stuffPacketRaw(VPacket* pck, Route* route, uint8_t* data, size_t len){
   uint16_t wptr = stuffPacketRoute(pck, route);
   // no bigguns... 
   if(len + wptr > route->maxSegmentSize){ 
-    OSAP_ERROR("oversize raw-write" + String(wptr + len)); 
+    OSAP_LOG(LOGCODE_OVERSIZE_RAW_WRITE, wptr + len); 
     len = 1; 
   }
   // now stuff the data, 
@@ -228,12 +329,96 @@ void stuffPacketRaw(VPacket* pck, Route* route, uint8_t* data, size_t len){
 }
 
 // stuffing from:to port,
+#ifdef OSAP_CONFIG_INCLUDE_ROUTE_IDS
+// interned routes go as | PTR | PHTTL:2 | MSS:2 | TKEY_RIDF | label | payload |
+// once installed, and this returns false if we should write a regular (install) packet instead, 
+boolean stuffPacketInterned(VPacket* pck, Route* route, uint16_t sourcePort, uint16_t destinationPort, uint8_t* data, size_t len){
+  if(!routeIdValid(route, sourcePort, destinationPort)) return false;
+  if(len + 5 + TKEY_RIDF_INC > route->maxSegmentSize) return false;
+  pck->data[0] = 5;
+  uint16_t wptr = 1;
+  serializers_writeUint16(pck->data, &wptr, route->perHopTimeToLive);
+  serializers_writeUint16(pck->data, &wptr, route->maxSegmentSize);
+  pck->data[wptr ++] = TKEY_RIDF;
+  pck->data[wptr ++] = route->routeID;
+  memcpy(&(pck->data[wptr]), data, len);
+  pck->len = len + wptr;
+  pck->serviceDeadline = millis() + route->perHopTimeToLive;
+  routeIdGet(route->routeID)->lastUsed = millis();
+  return true;
+}
+
+// and installs are the regular path w/ LINKF -> LINKF_RI, PORTPACK -> PORTPACK_RI, 
+// w/ our own (origin) label in the first instruction, 
+boolean stuffPacketInstall(VPacket* pck, Route* route, uint16_t sourcePort, uint16_t destinationPort, uint8_t* data, size_t len){
+  if(!routeIdEligible(route)) return false;
+  uint16_t hops = route->encodedPathLen / TKEY_LINKF_INC;
+  if(len + 5 + hops * TKEY_LINKF_RI_INC + 5 > route->maxSegmentSize) return false;
+  // our entry: the same one on refreshes, so that hops downstream find theirs too, 
+  uint16_t label = routeIdOwned(route) ? route->routeID : routeIdInstall(ROUTEID_INGRESS_LOCAL, 0);
+  RouteIDEntry* entry = routeIdGet(label);
+  entry->lastUsed = millis();
+  entry->key = TKEY_LINKF;
+  entry->a = serializers_readUint16(route->encodedPath, 1);
+  route->routeID = label;
+  route->routeIDTag = entry->tag;
+  route->routeIDSource = sourcePort;
+  route->routeIDDestination = destinationPort;
+  route->routeIDInstalledAt = millis();
+  // the header, 
+  pck->data[0] = 5;
+  uint16_t wptr = 1;
+  serializers_writeUint16(pck->data, &wptr, route->perHopTimeToLive);
+  serializers_writeUint16(pck->data, &wptr, route->maxSegmentSize);
+  // the path, 
+  for(uint16_t h = 0; h < hops; h ++){
+    pck->data[wptr ++] = TKEY_LINKF_RI;
+    pck->data[wptr ++] = route->encodedPath[h * TKEY_LINKF_INC + 1];
+    pck->data[wptr ++] = route->encodedPath[h * TKEY_LINKF_INC + 2];
+    serializers_writeUint16(pck->data, &wptr, (h == 0) ? label : 0);
+  }
+  // the port-pack, 
+  pck->data[wptr ++] = TKEY_PORTPACK_RI;
+  serializers_writeUint16(pck->data, &wptr, sourcePort);
+  serializers_writeUint16(pck->data, &wptr, destinationPort);
+  memcpy(&(pck->data[wptr]), data, len);
+  pck->len = len + wptr;
+  pck->serviceDeadline = millis() + route->perHopTimeToLive;
+  return true;
+}
+#endif 
+
 void stuffPacketPortToPort(VPacket* pck, Route* route, uint16_t sourcePort, uint16_t destinationPort, uint8_t* data, size_t len){
+  #ifdef OSAP_CONFIG_INCLUDE_ROUTE_IDS
+  // (stuffPacketRoute() does this for the rest), 
+  OSAP_Runtime::getInstance()->fitRoute(route);
+  if(route->interned){
+    if(stuffPacketInterned(pck, route, sourcePort, destinationPort, data, len)) return;
+    if(stuffPacketInstall(pck, route, sourcePort, destinationPort, data, len)) return;
+  }
+  #endif 
+  // short routes (all hops v2) get the short port-pack, if the indices fit, 
+  boolean isShort = (route->encodedPathLen > 0 && sourcePort < 256 && destinationPort < 256);
+  for(uint16_t i = 0; isShort && i < route->encodedPathLen; i += TKEY_LINKF_S_INC){
+    if(route->encodedPath[i] != TKEY_LINKF_S) isShort = false;
+  }
   // pretty similar to above, 
   uint16_t wptr = stuffPacketRoute(pck, route);
+  if(isShort){
+    if(len + wptr + TKEY_PORTPACK_S_INC > route->maxSegmentSize){ 
+      OSAP_LOG(LOGCODE_OVERSIZE_PORT_WRITE, wptr + len); 
+      len = 1; 
+    }
+    pck->data[wptr ++] = TKEY_PORTPACK_S;
+    pck->data[wptr ++] = sourcePort;
+    pck->data[wptr ++] = destinationPort;
+    memcpy(&(pck->data[wptr]), data, len);
+    pck->len = len + wptr;
+    return;
+  }
   // guard largess
   if(len + wptr + 5 > route->maxSegmentSize){ 
-    OSAP_ERROR("oversize port-write" + String(wptr + len)); 
+    OSAP_LOG(LOGCODE_OVERSIZE_PORT_WRITE, wptr + len); 
     len = 1; 
   }
   // author port-key-stuff, 
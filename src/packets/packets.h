@@ -19,6 +19,7 @@ no warranty is provided, and users accept all liability.
 #include "routes.h"
 #include "../structure/ports.h"
 #include "../structure/links.h"
+#include "../structure/busses.h"
 
 // ---------------------------------------------- The Packet Structure 
 
@@ -38,6 +39,9 @@ typedef struct VPacket {
   // when vport == nullptr, the packet is unallocated 
   VPort* vport = nullptr;
   LGateway* lgateway = nullptr;
+  #ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+  BGateway* bgateway = nullptr;
+  #endif 
 
   // won't need this source until runtime can perform scope-checks, 
   // Runtime* runtime = nullptr; 
@@ -63,15 +67,24 @@ void stackReset(VPacket* stack, size_t stackSize);
 // api for the runtime to collect a list 
 size_t stackGetPacketsToService(VPacket** packets, size_t maxPackets);
 
+// most packets ever allocated at once, since reset
+size_t stackGetHighWaterMark(void);
+
 // ---------------------------------------------- Get / Relinquish Packets from / to the Stack 
 
 // these are overloaded for various packet-accessors 
 VPacket* getPacketFromStack(VPort* vport);
 VPacket* getPacketFromStack(LGateway* lgateway);
+#ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+VPacket* getPacketFromStack(BGateway* bgateway);
+#endif 
 
 // vports .clearToSend() requires that they check w/o actually allocating
 boolean getPacketCheck(VPort* vport);
 boolean getPacketCheck(LGateway* lgateway);
+#ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+boolean getPacketCheck(BGateway* bgateway);
+#endif 
 
 // giving it up, 
 void relinquishPacketToStack(VPacket* pck);
@@ -80,9 +93,15 @@ void relinquishPacketToStack(VPacket* pck);
 
 // copies route data from a packet into a (provided) route object 
 void getRouteFromPacket(VPacket* pck, Route* route);
+// where the route's last instruction starts, or 0 if it has none: at a destination, 
+// that's the (reversed) instruction we arrived on, 
+uint16_t routeLastInstruction(uint8_t* data, size_t maxLen);
 
 // ---------------------------------------------- Packet Stuffing 
 
+// writes the | PTR | PHTTL:2 | MSS:2 | route | head, returning the next write position 
+uint16_t stuffPacketRoute(VPacket* pck, Route* route);
+
 // stuffing into allocated packet, 
 void stuffPacketRaw(VPacket* pck, Route* route, uint8_t* data, size_t len);
 
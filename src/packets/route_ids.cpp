@@ -0,0 +1,112 @@
+/*
+osap/route_ids.cpp
+
+interned routes: short labels in place of whole paths 
+
+Jake Read at the Center for Bits and Atoms
+(c) Massachusetts Institute of Technology 2022
+
+This work may be reproduced, modified, distributed, performed, and
+displayed for any purpose, but must acknowledge the osap project.
+Copyright is retained and must be preserved. The work is provided as is;
+no warranty is provided, and users accept all liability.
+*/
+
+#include "route_ids.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_ROUTE_IDS
+
+#include "../utils/keys.h"
+#include "../utils/serializers.h"
+
+static_assert(OSAP_CONFIG_ROUTEID_TABLE_SIZE <= 255, "OSAP_CONFIG_ROUTEID_TABLE_SIZE must be 255 or fewer (labels are one byte)");
+
+RouteIDEntry routeIdTable[OSAP_CONFIG_ROUTEID_TABLE_SIZE];
+
+uint16_t routeIdFind(uint16_t ingress, uint16_t upstreamLabel){
+  for(uint16_t e = 0; e < OSAP_CONFIG_ROUTEID_TABLE_SIZE; e ++){
+    if(routeIdTable[e].ingress == ingress && routeIdTable[e].upstreamLabel == upstreamLabel){
+      return e;
+    }
+  }
+  return ROUTEID_NONE;
+}
+
+uint16_t routeIdInstall(uint16_t ingress, uint16_t upstreamLabel){
+  // origin entries are always fresh, others re-use their key's slot 
+  uint16_t e = (ingress == ROUTEID_INGRESS_LOCAL) ? ROUTEID_NONE : routeIdFind(ingress, upstreamLabel);
+  if(e == ROUTEID_NONE){
+    // free slot, else the stalest one, 
+    uint32_t now = millis();
+    uint32_t oldest = 0;
+    for(uint16_t i = 0; i < OSAP_CONFIG_ROUTEID_TABLE_SIZE; i ++){
+      if(routeIdTable[i].ingress == ROUTEID_INGRESS_FREE){
+        e = i;
+        break;
+      }
+      if(now - routeIdTable[i].lastUsed >= oldest){
+        oldest = now - routeIdTable[i].lastUsed;
+        e = i;
+      }
+    }
+    routeIdTable[e].tag ++;
+  }
+  RouteIDEntry* entry = &(routeIdTable[e]);
+  entry->ingress = ingress;
+  entry->upstreamLabel = upstreamLabel;
+  entry->reversePathLen = 0;
+  entry->lastUsed = millis();
+  return e;
+}
+
+RouteIDEntry* routeIdGet(uint16_t label){
+  if(label >= OSAP_CONFIG_ROUTEID_TABLE_SIZE) return nullptr;
+  return &(routeIdTable[label]);
+}
+
+boolean routeIdEligible(Route* route){
+  // only link hops for now, and at least one of them, 
+  if(route->encodedPathLen == 0) return false;
+  for(uint16_t i = 0; i < route->encodedPathLen; i += TKEY_LINKF_INC){
+    if(route->encodedPath[i] != TKEY_LINKF) return false;
+  }
+  // installs are 2 bytes / hop larger, 
+  return (route->encodedPathLen / TKEY_LINKF_INC) * TKEY_LINKF_RI_INC <= OSAP_CONFIG_ROUTE_MAX_LENGTH;
+}
+
+boolean routeIdOwned(Route* route){
+  RouteIDEntry* entry = routeIdGet(route->routeID);
+  if(entry == nullptr) return false;
+  // has our origin entry been recycled ? 
+  return (entry->ingress == ROUTEID_INGRESS_LOCAL && entry->tag == route->routeIDTag);
+}
+
+boolean routeIdValid(Route* route, uint16_t sourcePort, uint16_t destinationPort){
+  if(!routeIdOwned(route)) return false;
+  // same ports ? 
+  if(route->routeIDSource != sourcePort || route->routeIDDestination != destinationPort) return false;
+  // and refresh now and then, in case a hop has lost it 
+  if(millis() - route->routeIDInstalledAt > OSAP_CONFIG_ROUTEID_REFRESH_MS) return false;
+  return true;
+}
+
+void routeIdStrip(Route* route){
+  uint16_t rptr = 0;
+  uint16_t wptr = 0;
+  while(rptr < route->encodedPathLen){
+    if(route->encodedPath[rptr] == TKEY_LINKF_RI){
+      route->encodedPath[wptr ++] = TKEY_LINKF;
+      route->encodedPath[wptr ++] = route->encodedPath[rptr + 1];
+      route->encodedPath[wptr ++] = route->encodedPath[rptr + 2];
+      rptr += TKEY_LINKF_RI_INC;
+    } else {
+      uint8_t increment = getKeyIncrement(route->encodedPath[rptr]);
+      memmove(&(route->encodedPath[wptr]), &(route->encodedPath[rptr]), increment);
+      wptr += increment;
+      rptr += increment;
+    }
+  }
+  route->encodedPathLen = wptr;
+}
+
+#endif 
@@ -0,0 +1,74 @@
+/*
+osap/route_ids.h
+
+interned routes: short labels in place of whole paths 
+
+Jake Read at the Center for Bits and Atoms
+(c) Massachusetts Institute of Technology 2022
+
+This work may be reproduced, modified, distributed, performed, and
+displayed for any purpose, but must acknowledge the osap project.
+Copyright is retained and must be preserved. The work is provided as is;
+no warranty is provided, and users accept all liability.
+*/
+
+#ifndef OSAP_ROUTE_IDS_H_
+#define OSAP_ROUTE_IDS_H_
+
+#include <Arduino.h>
+#include "../osap_config.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_ROUTE_IDS
+
+#include "routes.h"
+
+// a sender w/ an interned route (see Route::intern()) sends the first packet w/ each 
+// LINKF written as | TKEY_LINKF_RI | index:2 | label:2 | and the PORTPACK as TKEY_PORTPACK_RI, 
+// every hop then stores an entry keyed on (the link it came in on, the upstream hop's label), 
+// and writes its own label (the entry's index) into the instruction before passing it on, 
+// since each link has one upstream runtime, that key is unambiguous w/o any global IDs: 
+// later packets are | PTR=5 | PHTTL:2 | MSS:2 | TKEY_RIDF | label | payload | 
+// and each hop swaps the label for its own, the last hop delivering w/ its stored ports + reverse path, 
+// the ingress half of the key isn't on the wire: it's the link that picked the packet up, 
+// so labels are one byte, and tables hold at most 255 entries 
+// origins keep their label across refreshes, so re-installs land in the same entries all the way down 
+
+// entries at the origin aren't keyed on a link, 
+#define ROUTEID_INGRESS_LOCAL 0xFFFF 
+#define ROUTEID_INGRESS_FREE 0xFFFE 
+#define ROUTEID_NONE 0xFFFF 
+
+typedef struct RouteIDEntry {
+  // key, 
+  uint16_t ingress = ROUTEID_INGRESS_FREE;
+  uint16_t upstreamLabel = 0;
+  // what to do: TKEY_LINKF (a = link) or TKEY_PORTPACK (a = source, b = destination port) 
+  uint8_t key = 0;
+  uint16_t a = 0;
+  uint16_t b = 0;
+  // bumped on each re-allocation, so origins can tell their entry has been recycled 
+  uint8_t tag = 0;
+  uint32_t lastUsed = 0;
+  // delivery entries keep the (plain, reversed) path back to the sender, 
+  uint8_t reversePath[OSAP_CONFIG_ROUTE_MAX_LENGTH];
+  uint8_t reversePathLen = 0;
+} RouteIDEntry;
+
+// find-or-allocate the entry for a key, evicting the least-recently-used if full, 
+// origin entries (ROUTEID_INGRESS_LOCAL) are always fresh: re-use them w/ routeIdValid() 
+uint16_t routeIdInstall(uint16_t ingress, uint16_t upstreamLabel);
+// find the entry for a key, or ROUTEID_NONE 
+uint16_t routeIdFind(uint16_t ingress, uint16_t upstreamLabel);
+RouteIDEntry* routeIdGet(uint16_t label);
+
+// sender-side: can this route go interned, is its origin entry still ours, 
+// and is it still good to send on (or due for a refresh) ? 
+boolean routeIdEligible(Route* route);
+boolean routeIdOwned(Route* route);
+boolean routeIdValid(Route* route, uint16_t sourcePort, uint16_t destinationPort);
+
+// rewrite TKEY_LINKF_RI instructions back to TKEY_LINKF, 
+void routeIdStrip(Route* route);
+
+#endif 
+#endif 
@@ -15,7 +15,8 @@ no warranty is provided, and users accept all liability.
 #include "routes.h"
 #include "../utils/keys.h"
 #include "../utils/serializers.h"
-#include "../utils/debug.h"
+#include "../utils/log.h"
+#include "../runtime/runtime.h"
 
 // these two includes only required for the debug... 
 // #include "../utils/debug.h"
@@ -44,18 +45,59 @@ Route* Route::linkf(uint16_t txIndex){
 }
 
 Route* Route::busf(uint16_t txIndex, uint16_t txAddress){
-  encodedPath[encodedPathLen ++] = TKEY_LINKF;
+  encodedPath[encodedPathLen ++] = TKEY_BUSF;
   serializers_writeUint16(encodedPath, &encodedPathLen, txIndex);
   serializers_writeUint16(encodedPath, &encodedPathLen, txAddress);
   return this;
 }
 
+Route* Route::busb(uint16_t txIndex, uint16_t channel){
+  encodedPath[encodedPathLen ++] = TKEY_BUSB;
+  serializers_writeUint16(encodedPath, &encodedPathLen, txIndex);
+  serializers_writeUint16(encodedPath, &encodedPathLen, channel);
+  return this;
+}
+
+Route* Route::shorten(void){
+  uint16_t rptr = 0;
+  uint16_t wptr = 0;
+  while(rptr < encodedPathLen){
+    uint8_t increment = getKeyIncrement(encodedPath[rptr]);
+    if(encodedPath[rptr] == TKEY_LINKF && encodedPath[rptr + 2] == 0){
+      encodedPath[wptr ++] = TKEY_LINKF_S;
+      encodedPath[wptr ++] = encodedPath[rptr + 1];
+    } else {
+      memmove(&(encodedPath[wptr]), &(encodedPath[rptr]), increment);
+      wptr += increment;
+    }
+    rptr += increment;
+  }
+  encodedPathLen = wptr;
+  return this;
+}
+
 Route* Route::end(uint16_t _perHopTimeToLive, uint16_t _maxSegmentSize){
   perHopTimeToLive = _perHopTimeToLive;
   maxSegmentSize = _maxSegmentSize;
   return this;
 }
 
+#ifdef OSAP_CONFIG_INCLUDE_ROUTE_IDS
+Route* Route::intern(void){
+  interned = true;
+  routeID = 0xFFFF;
+  return this;
+}
+#endif 
+
+size_t Route::maxPayload(void){
+  OSAP_Runtime::getInstance()->fitRoute(this);
+  // | PTR | PHTTL:2 | MSS:2 | path | TKEY_PORTPACK | src:2 | dst:2 | 
+  size_t overhead = 5 + encodedPathLen + 5;
+  size_t segment = (maxSegmentSize > OSAP_CONFIG_PACKET_MAX_SIZE) ? OSAP_CONFIG_PACKET_MAX_SIZE : maxSegmentSize;
+  return (segment > overhead) ? segment - overhead : 0;
+}
+
 // TODO: it seems like (?) we could shave this chunk of RAM 
 // by using some other temporary buffer, like the Port::payload or Port::datagram 
 // but would need to analyze whether / not those are likely to be mid-write 
@@ -66,14 +108,21 @@ uint8_t getKeyIncrement(uint8_t key){
   switch(key){
     case TKEY_LINKF:
       return 3;
+    case TKEY_LINKF_S:
+      return 2;
+    case TKEY_PORTPACK_S:
+      return 3;
     case TKEY_PORTPACK:
     case TKEY_BUSF:
+    case TKEY_BUSB:
+    case TKEY_LINKF_RI:
+    case TKEY_PORTPACK_RI:
       return 5;
     default:
       // everything else is bunko 
       // but if we return... something, we won't hang-up 
       // the while() loops that call this ute... 
-      OSAP_ERROR("bad key_getIncrement value " + String(key));
+      OSAP_LOG(LOGCODE_BAD_KEY_INCREMENT, key);
       return 3;
   }
 }
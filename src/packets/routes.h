@@ -18,6 +18,9 @@ no warranty is provided, and users accept all liability.
 #include <Arduino.h>
 #include "../osap_config.h"
 
+// bytes-per-instruction for a transport key, 
+uint8_t getKeyIncrement(uint8_t key);
+
 // a route type...
 class Route {
   public:
@@ -39,6 +42,10 @@ class Route {
     // reverse the route in-place
     void reverse(void);
 
+    // the most a port-to-port payload on this route can carry: the segment (fit to our first hop), 
+    // less the header, the path, and the port-pack, and no more than a packet 
+    size_t maxPayload(void);
+
     // pass-thru initialize constructors;
     Route(void);
 
@@ -46,8 +53,27 @@ class Route {
     Route* linkf(uint16_t txIndex);
     // append a bus-forwarding instruction to the route 
     Route* busf(uint16_t txIndex, uint16_t txAddress);
+    // append a bus-broadcast instruction, reaching every drop subscribed to the channel 
+    Route* busb(uint16_t txIndex, uint16_t channel);
+    // re-write the route's link instructions in their short (v2) forms, where indices fit, 
+    // only for routes where every runtime along the way is new enough to read them, 
+    // port-to-port packets on a short route also use the short port-pack 
+    Route* shorten(void);
     // finish the route ?
     Route* end(uint16_t perHopTimeToLive = 2000, uint16_t maxSegmentSize = OSAP_CONFIG_PACKET_MAX_SIZE);
+
+    #ifdef OSAP_CONFIG_INCLUDE_ROUTE_IDS
+    // send port-to-port packets on this route as a short label, see packets/route_ids.h, 
+    // call this again whenever the path changes 
+    Route* intern(void);
+    // and the sender's state for that, 
+    boolean interned = false;
+    uint16_t routeID = 0xFFFF;
+    uint8_t routeIDTag = 0;
+    uint16_t routeIDSource = 0;
+    uint16_t routeIDDestination = 0;
+    uint32_t routeIDInstalledAt = 0;
+    #endif 
 };
 
 #endif
@@ -0,0 +1,59 @@
+// a port for coroutines: co_await sends and requests
+
+#include "port_coroutine.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_COROUTINES
+
+OSAP_Port_Coroutine::OSAP_Port_Coroutine(
+  const char* _name,
+  void (*_onMessage)(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort)
+  ) : VPort(OSAP_Runtime::getInstance())
+{
+  // the name should be a literal, we keep the pointer,
+  name = _name;
+  onMessage = _onMessage;
+}
+
+const char* OSAP_Port_Coroutine::getName(uint8_t i){
+  return (i == 0) ? name : nullptr;
+}
+
+OSAP_Port_Coroutine::SendAwaiter OSAP_Port_Coroutine::send(uint8_t* data, size_t len, Route* route, uint16_t destinationPort){
+  SendAwaiter awaiter;
+  awaiter.wait.kind = COWAIT_SEND;
+  awaiter.wait.vport = this;
+  awaiter.wait.data = data;
+  awaiter.wait.len = len;
+  awaiter.wait.route = route;
+  awaiter.wait.destinationPort = destinationPort;
+  return awaiter;
+}
+
+OSAP_Port_Coroutine::RequestAwaiter OSAP_Port_Coroutine::request(uint8_t* data, size_t len, Route* route, uint16_t destinationPort, uint8_t* reply, size_t replySize, uint32_t timeout){
+  RequestAwaiter awaiter;
+  awaiter.wait.kind = COWAIT_REQUEST_SEND;
+  awaiter.wait.vport = this;
+  awaiter.wait.data = data;
+  awaiter.wait.len = len;
+  awaiter.wait.route = route;
+  awaiter.wait.destinationPort = destinationPort;
+  awaiter.wait.msgID = nextMsgID ++;
+  awaiter.wait.reply = reply;
+  awaiter.wait.replySize = replySize;
+  awaiter.wait.timeout = timeout;
+  return awaiter;
+}
+
+void OSAP_Port_Coroutine::onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort){
+  // replies are copied out, and their tasks resumed on the next loop,
+  OSAP_CoWait* wait = (len >= 2) ? coroutinesFindRequest(this, data[1], sourceRoute, sourcePort) : nullptr;
+  if(wait != nullptr){
+    wait->replyLen = (len > wait->replySize) ? wait->replySize : len;
+    memcpy(wait->reply, data, wait->replyLen);
+    wait->replied = true;
+    return;
+  }
+  if(onMessage != nullptr) onMessage(data, len, sourceRoute, sourcePort);
+}
+
+#endif
@@ -0,0 +1,68 @@
+// a port for coroutines: co_await sends and requests
+
+#ifndef PORT_COROUTINE_H_
+#define PORT_COROUTINE_H_
+
+#include "../structure/ports.h"
+#include "../runtime/coroutines.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_COROUTINES
+
+// from an OSAP_Task (see runtime/coroutines.h),
+//
+// uint8_t req[8] = { PRPC_KEY_FUNCCALL, 0, ... };
+// uint8_t reply[32];
+// co_await port.send(data, len, &route, 1);    // waits for stack space, then sends
+// size_t len = co_await port.request(req, 8, &route, 1, reply, sizeof(reply));
+// if(len == 0) ... // timed out
+//
+// requests follow the | KEY | MSGID | ... | convention: we stamp our own id into data[1],
+// and the reply is whichever message comes back from that port, along that route, w/ the same MSGID,
+// requests time out `timeout` ms after the co_await, whether or not they've gone out by then,
+// data and the route are read after the task suspends, so they shouldn't be a task's locals,
+// other messages go to the onMessage handler, if there is one
+
+class OSAP_Port_Coroutine : public VPort {
+  public:
+    // -------------------------------- Constructors
+    OSAP_Port_Coroutine(const char* _name, void (*_onMessage)(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) = nullptr);
+
+    // -------------------------------- Awaitables
+    struct SendAwaiter {
+      OSAP_CoWait wait;
+      boolean await_ready(void){ return wait.vport->clearToSend(); }
+      void await_suspend(std::coroutine_handle<> handle){
+        wait.handle = handle;
+        coroutinesWait(&wait);
+      }
+      void await_resume(void){
+        wait.vport->send(wait.data, wait.len, wait.route, wait.destinationPort);
+      }
+    };
+    struct RequestAwaiter {
+      OSAP_CoWait wait;
+      // there's no MSGID slot to stamp w/o | KEY | MSGID |, so no way to match a reply: those fail straight away,
+      boolean await_ready(void){ return wait.len < 2; }
+      void await_suspend(std::coroutine_handle<> handle){
+        wait.handle = handle;
+        coroutinesWait(&wait);
+      }
+      // the reply's length (w/ its KEY and MSGID), truncated to replySize, or 0 if none came
+      size_t await_resume(void){ return wait.replied ? wait.replyLen : 0; }
+    };
+    // n.b. these hide VPort::send, which is still there as VPort::send(...)
+    SendAwaiter send(uint8_t* data, size_t len, Route* route, uint16_t destinationPort);
+    RequestAwaiter request(uint8_t* data, size_t len, Route* route, uint16_t destinationPort, uint8_t* reply, size_t replySize, uint32_t timeout = OSAP_CONFIG_COROUTINE_REQUEST_TIMEOUT_MS);
+
+    // -------------------------------- OSAP-Facing API
+    void onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) override;
+    const char* getName(uint8_t i) override;
+
+  private:
+    const char* name;
+    void (*onMessage)(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) = nullptr;
+    uint8_t nextMsgID = 0;
+};
+
+#endif
+#endif
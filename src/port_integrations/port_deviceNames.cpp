@@ -53,6 +53,8 @@ void OSAP_Port_DeviceNames::begin(void){
 void OSAP_Port_DeviceNames::setUniqueName(const char* _uniqueName){
   strncpy(uniqueName, _uniqueName, PDNAMES_NAME_MAX_CHARS);
   uniqueName[PDNAMES_NAME_MAX_CHARS - 1] = '\0';
+  // scanners' cached names are now stale, 
+  OSAP_Runtime::getInstance()->bumpEpoch();
   // report! 
   OSAP_DEBUG("cmt: " + String(uniqueName));
   // and we'll want to write that to memory:
@@ -65,6 +67,14 @@ void OSAP_Port_DeviceNames::setUniqueName(const char* _uniqueName){
 
 // ------------------------------------ End Platform Dependent Codes
 
+const char* OSAP_Port_DeviceNames::getName(uint8_t i){
+  switch(i){
+    case 0: return typeName;
+    case 1: return uniqueName;
+    default: return nullptr;
+  }
+}
+
 void OSAP_Port_DeviceNames::onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort){
   switch(data[0]){
     case PDNAMEKEY_NAMEGET_REQ:
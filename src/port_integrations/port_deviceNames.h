@@ -23,6 +23,9 @@ class OSAP_Port_DeviceNames : public VPort {
     // override-this,
     void onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) override;
 
+    // type-name, then unique-name 
+    const char* getName(uint8_t i) override;
+
     // optional, settable unique-name:
     void setUniqueName(const char* _uniqueName);
 
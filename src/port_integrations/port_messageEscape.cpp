@@ -30,6 +30,10 @@ void OSAP_Port_MessageEscape::onPacket(uint8_t* data, size_t len, Route* sourceR
       escapePath.maxSegmentSize = sourceRoute->maxSegmentSize;
       // then the actual... (no memory guards lol good luck)
       memcpy(escapePath.encodedPath, &(sourceRoute->encodedPath), escapePath.encodedPathLen);
+      #ifdef OSAP_CONFIG_INCLUDE_ROUTE_IDS
+      // we re-use this one a lot, 
+      escapePath.intern();
+      #endif 
       // then we done baby, 
       break;
   };
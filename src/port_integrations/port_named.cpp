@@ -3,7 +3,8 @@
 #include "port_named.h"
 #include "../utils/serializers.h"
 
-#include "../utils/debug.h"
+#include "../utils/log.h"
+#include "../runtime/subscriptions.h"
 
 OSAP_Port_Named::OSAP_Port_Named(
   const char* _name, 
@@ -29,6 +30,22 @@ OSAP_Port_Named::OSAP_Port_Named(
   typeKey = PTYPEKEY_NAMED;
 }
 
+OSAP_Port_Named::OSAP_Port_Named(
+  const char* _name, 
+  size_t (*_onMsgFunction)(uint8_t* data, size_t len, uint8_t* reply, size_t maxLen)
+  ) : VPort(OSAP_Runtime::getInstance())
+{
+  // stash name & func, 
+  strncpy(name, _name, PNAMED_NAME_MAX_CHARS);
+  onMsgFunctionWithMaxLen = _onMsgFunction;
+  // report type
+  typeKey = PTYPEKEY_NAMED;
+}
+
+const char* OSAP_Port_Named::getName(uint8_t i){
+  return (i == 0) ? name : nullptr;
+}
+
 void OSAP_Port_Named::onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort){
   switch(data[0]){
     case PNAMED_NAMEREQ:
@@ -50,7 +67,16 @@ void OSAP_Port_Named::onPacket(uint8_t* data, size_t len, Route* sourceRoute, ui
         _payload[wptr ++] = PNAMED_ACK;
         _payload[wptr ++] = data[1];
         // call whichever func was attached by alternate constructors:
-        if(onMsgFunctionWithReply != nullptr){
+        if(onMsgFunctionWithMaxLen != nullptr){
+          size_t maxLen = sourceRoute->maxPayload();
+          if(maxLen < 2) break;
+          size_t replyLen = onMsgFunctionWithMaxLen(&(data[2]), len - 2, &(_payload[2]), maxLen - 2);
+          if(replyLen > maxLen - 2){
+            OSAP_LOG(LOGCODE_PNAMED_REPLY_TOO_LARGE, replyLen);
+            break;
+          }
+          wptr += replyLen;
+        } else if(onMsgFunctionWithReply != nullptr){
           // w/ reply: present payload's 1th byte as *data 
           // total replyLen is app's replyLen + 1 for the KEY_ACK, 
           wptr += onMsgFunctionWithReply(&(data[2]), len - 2, &(_payload[2]));
@@ -62,13 +88,42 @@ void OSAP_Port_Named::onPacket(uint8_t* data, size_t len, Route* sourceRoute, ui
         send(_payload, wptr, sourceRoute, sourcePort);
       }
       break;
+    case PNAMED_SUBSCRIBE:
+      {
+        // we can only stream replies, 
+        boolean ok = (onMsgFunctionWithReply != nullptr || onMsgFunctionWithMaxLen != nullptr) && subscriptionOpen(this, PNAMED_PUSH, data, len, sourceRoute, sourcePort);
+        _payload[0] = PNAMED_SUBRES;
+        _payload[1] = data[1];
+        _payload[2] = ok ? 1 : 0;
+        send(_payload, 3, sourceRoute, sourcePort);
+      }
+      break;
+    case PNAMED_UNSUBSCRIBE:
+      subscriptionClose(this, data[1], sourceRoute, sourcePort);
+      break;
     // we shouldn't encounter these in any embedded codes yet: 
     case PNAMED_NAMERES:
     case PNAMED_ACK:
-      OSAP_ERROR("PNAMED_NAMERES or ACK to fancy-embedded-implementer");
+      OSAP_LOG(LOGCODE_PNAMED_UNEXPECTED_RES, data[0]);
       break;
     default:
-      OSAP_ERROR("borked fancyport msg w/ 1st byte " + String(data[0]));
+      OSAP_LOG(LOGCODE_PORT_BAD_KEY, (typeKey << 8) | data[0]);
       break;
   }
 }
+
+boolean OSAP_Port_Named::sample(uint8_t* args, size_t argsLen, uint8_t* dest, size_t maxLen, size_t* len){
+  if(onMsgFunctionWithMaxLen != nullptr){
+    *len = onMsgFunctionWithMaxLen(args, argsLen, dest, maxLen);
+  } else if(onMsgFunctionWithReply != nullptr){
+    // these aren't told maxLen, so we can only check what they wrote, 
+    *len = onMsgFunctionWithReply(args, argsLen, dest);
+  } else {
+    return false;
+  }
+  if(*len > maxLen){
+    OSAP_LOG(LOGCODE_PNAMED_REPLY_TOO_LARGE, *len);
+    return false;
+  }
+  return true;
+}
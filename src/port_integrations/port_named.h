@@ -12,6 +12,11 @@
 #define PNAMED_NAMERES 2 
 #define PNAMED_MSG 3 
 #define PNAMED_ACK 4 
+// handlers w/ replies can be subscribed to, i.e. to stream them w/o polling, see runtime/subscriptions.h 
+#define PNAMED_SUBSCRIBE 5 
+#define PNAMED_SUBRES 6 
+#define PNAMED_PUSH 7 
+#define PNAMED_UNSUBSCRIBE 8 
 
 class OSAP_Port_Named : public VPort {
   public:
@@ -20,15 +25,22 @@ class OSAP_Port_Named : public VPort {
     OSAP_Port_Named(const char* _name, size_t (*_onMsgFunction)(uint8_t* data, size_t len, uint8_t* reply));
     // with a dummy func that has no reply 
     OSAP_Port_Named(const char* _name, void (*_onMsgFunction)(uint8_t* data, size_t len));
+    // or with a func that's told how much room there is for its reply, 
+    // (prefer this one: the first can only be checked after it's written) 
+    OSAP_Port_Named(const char* _name, size_t (*_onMsgFunction)(uint8_t* data, size_t len, uint8_t* reply, size_t maxLen));
 
     // -------------------------------- Port-Facing API
     // we override the onPacket handler, 
     void onPacket(uint8_t* data, size_t len, Route* route, uint16_t sourcePort) override;
+    const char* getName(uint8_t i) override;
+    // subscriptions call the handler w/ the msg they were opened with, and fail if its reply runs past maxLen, 
+    boolean sample(uint8_t* args, size_t argsLen, uint8_t* dest, size_t maxLen, size_t* len) override;
 
   private:
     // the user-provided name and callback
     char name[PNAMED_NAME_MAX_CHARS] = "portName";
     size_t (*onMsgFunctionWithReply)(uint8_t* data, size_t len, uint8_t* reply) = nullptr;
+    size_t (*onMsgFunctionWithMaxLen)(uint8_t* data, size_t len, uint8_t* reply, size_t maxLen) = nullptr;
     void (*onMsgFunctionWithoutReply)(uint8_t* data, size_t len) = nullptr;
 };
 
@@ -1,48 +1,197 @@
-// pipe-er 
+// pipe-er
 
 #include "port_onePipe.h"
 #include "../utils/serializers.h"
+#include "../utils/log.h"
+
+// | PONEPIPE_MSGS | SEQ:4 | N |
+#define PONEPIPE_MSGS_HEADER_LEN 6
 
 OSAP_Port_OnePipe::OSAP_Port_OnePipe(const char* _name) : VPort(OSAP_Runtime::getInstance()){
   strncpy(name, _name, PONEPIPE_NAME_MAX_CHARS);
   typeKey = PTYPEKEY_ONE_PIPE;
 }
 
+const char* OSAP_Port_OnePipe::getName(uint8_t i){
+  return (i == 0) ? name : nullptr;
+}
+
+// subscribers are known by their route (as it arrives) and port,
+OnePipeSubscriber* OSAP_Port_OnePipe::findSubscriber(Route* route, uint16_t port){
+  for(uint8_t s = 0; s < OSAP_CONFIG_ONEPIPE_MAX_SUBSCRIBERS; s ++){
+    OnePipeSubscriber* sub = &(subscribers[s]);
+    if(!sub->active || sub->port != port || sub->route.encodedPathLen != route->encodedPathLen) continue;
+    if(memcmp(sub->route.encodedPath, route->encodedPath, route->encodedPathLen) == 0) return sub;
+  }
+  return nullptr;
+}
+
 void OSAP_Port_OnePipe::onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort){
-  // readptr 
+  // readptr
   uint16_t rptr = 0;
   switch(data[rptr ++]){
     case PONEPIPE_SETUP:
       {
-        upPort = sourcePort;
-        // and stash flipped route, 
-        upRoute.encodedPathLen = sourceRoute->encodedPathLen;
-        upRoute.perHopTimeToLive = sourceRoute->perHopTimeToLive;
-        upRoute.maxSegmentSize = sourceRoute->maxSegmentSize;
-        // then the actual... (no memory guards lol good luck)
-        memcpy(upRoute.encodedPath, &(sourceRoute->encodedPath), upRoute.encodedPathLen);
+        // a repeat setup refreshes the route, others take a free slot,
+        OnePipeSubscriber* sub = findSubscriber(sourceRoute, sourcePort);
+        for(uint8_t s = 0; s < OSAP_CONFIG_ONEPIPE_MAX_SUBSCRIBERS && sub == nullptr; s ++){
+          if(!subscribers[s].active) sub = &(subscribers[s]);
+        }
+        // if we're full, they hear nothing back,
+        if(sub == nullptr){
+          OSAP_LOG(LOGCODE_PONEPIPE_FULL, sourcePort);
+          break;
+        }
+        // new ones start w/ whatever's buffered,
+        if(!sub->active){
+          sub->cursor = ringTail;
+          sub->seq = tailSeq;
+        }
+        sub->port = sourcePort;
+        // and stash flipped route,
+        sub->route = *sourceRoute;
+        #ifdef OSAP_CONFIG_INCLUDE_ROUTE_IDS
+        // we re-use this one a lot,
+        sub->route.intern();
+        #endif
+        sub->active = true;
         // then reply w/ our name:
         uint16_t wptr = 0;
-        outBuffer[wptr ++] = PONEPIPE_SETUP_RES;
-        serializers_writeString(outBuffer, &wptr, name);
-        // and reply like... 
-        send(outBuffer, wptr, sourceRoute, sourcePort);
+        _payload[wptr ++] = PONEPIPE_SETUP_RES;
+        serializers_writeString(_payload, &wptr, name);
+        // and reply like...
+        send(_payload, wptr, sourceRoute, sourcePort);
       }
-      // then we done baby, 
+      // then we done baby,
       break;
+    case PONEPIPE_TEARDOWN:
+      {
+        OnePipeSubscriber* sub = findSubscriber(sourceRoute, sourcePort);
+        if(sub == nullptr) break;
+        sub->active = false;
+      }
+      break;
+  }
+}
+
+boolean OSAP_Port_OnePipe::write(uint8_t* data, size_t len){
+  // samples longer than a packet (or the LEN byte) can't ever go out, these are refused
+  // w/o taking a sequence number: they're the writer's mistake, not a loss on the way,
+  if(len > 255 || len + 1 > OSAP_CONFIG_ONEPIPE_RING_SIZE || len + 1 + PONEPIPE_MSGS_HEADER_LEN > OSAP_CONFIG_PACKET_MAX_SIZE){
+    OSAP_LOG(LOGCODE_OVERSIZE_PORT_WRITE, len);
+    return false;
+  }
+  // make room, oldest-out, (subscribers that hadn't got those yet skip ahead, and see a gap in SEQ)
+  while(OSAP_CONFIG_ONEPIPE_RING_SIZE - ringUsed < len + 1){
+    ringPop();
+    samplesDropped ++;
+  }
+  for(uint8_t s = 0; s < OSAP_CONFIG_ONEPIPE_MAX_SUBSCRIBERS; s ++){
+    OnePipeSubscriber* sub = &(subscribers[s]);
+    if(sub->active && (int32_t)(sub->seq - tailSeq) < 0){
+      sub->cursor = ringTail;
+      sub->seq = tailSeq;
+    }
+  }
+  // and stash it,
+  ring[ringHead] = len;
+  ringHead = (ringHead + 1) % OSAP_CONFIG_ONEPIPE_RING_SIZE;
+  size_t first = OSAP_CONFIG_ONEPIPE_RING_SIZE - ringHead;
+  if(first > len) first = len;
+  memcpy(&(ring[ringHead]), data, first);
+  memcpy(ring, &(data[first]), len - first);
+  ringHead = (ringHead + len) % OSAP_CONFIG_ONEPIPE_RING_SIZE;
+  ringUsed += len + 1;
+  ringCount ++;
+  // it might go right away,
+  flush();
+  return true;
+}
+
+void OSAP_Port_OnePipe::loop(void){
+  flush();
+}
+
+// copies the sample at `at` (w/o its LEN) into dest,
+void OSAP_Port_OnePipe::ringCopyOut(size_t at, uint8_t* dest, size_t len){
+  size_t start = (at + 1) % OSAP_CONFIG_ONEPIPE_RING_SIZE;
+  size_t first = OSAP_CONFIG_ONEPIPE_RING_SIZE - start;
+  if(first > len) first = len;
+  memcpy(dest, &(ring[start]), first);
+  memcpy(&(dest[first]), ring, len - first);
+}
+
+void OSAP_Port_OnePipe::ringPop(void){
+  size_t len = ring[ringTail];
+  ringTail = (ringTail + 1 + len) % OSAP_CONFIG_ONEPIPE_RING_SIZE;
+  ringUsed -= len + 1;
+  ringCount --;
+  tailSeq ++;
+}
+
+void OSAP_Port_OnePipe::ringRelease(void){
+  // w/ no one subscribed, samples wait (up to the ring's size) for someone to,
+  boolean any = false;
+  uint32_t done = ringCount;
+  for(uint8_t s = 0; s < OSAP_CONFIG_ONEPIPE_MAX_SUBSCRIBERS; s ++){
+    if(!subscribers[s].active) continue;
+    any = true;
+    uint32_t subDone = subscribers[s].seq - tailSeq;
+    if(subDone < done) done = subDone;
   }
+  if(!any) return;
+  while(done -- > 0) ringPop();
 }
 
-void OSAP_Port_OnePipe::write(uint8_t* data, size_t len){
-  // blind failure, beware !
-  // could do...if not clear, stuff sample into datagram until are clear 
-  if(!clearToSend()) return;
-  // stuff it and... 
+void OSAP_Port_OnePipe::sendTo(OnePipeSubscriber* sub){
+  size_t maxLen = sub->route.maxPayload();
+  uint32_t headSeq = tailSeq + ringCount;
   uint16_t wptr = 0;
-  outBuffer[wptr ++] = PONEPIPE_MSG;
-  if(len > 128) return;
-  memcpy(outBuffer + 1, data, len);
-  wptr += len; 
-  send(outBuffer, wptr, &upRoute, upPort);
-  // we're done, lol ? x
-}
\ No newline at end of file
+  _payload[wptr ++] = PONEPIPE_MSGS;
+  serializers_writeUint32(_payload, &wptr, sub->seq);
+  size_t nPtr = wptr ++;
+  uint8_t n = 0;
+  while(sub->seq != headSeq && n < 255){
+    size_t len = ring[sub->cursor];
+    if(wptr + 1 + len > maxLen) break;
+    _payload[wptr ++] = len;
+    ringCopyOut(sub->cursor, &(_payload[wptr]), len);
+    wptr += len;
+    sub->cursor = (sub->cursor + 1 + len) % OSAP_CONFIG_ONEPIPE_RING_SIZE;
+    sub->seq ++;
+    n ++;
+  }
+  // a sample that's too large for this route would hold up the rest, so they skip it,
+  if(n == 0){
+    OSAP_LOG(LOGCODE_OVERSIZE_PORT_WRITE, ring[sub->cursor]);
+    sub->cursor = (sub->cursor + 1 + ring[sub->cursor]) % OSAP_CONFIG_ONEPIPE_RING_SIZE;
+    sub->seq ++;
+    return;
+  }
+  _payload[nPtr] = n;
+  send(_payload, wptr, &(sub->route), sub->port);
+}
+
+void OSAP_Port_OnePipe::flush(void){
+  // subscribers that have gone away stop holding up the others,
+  OSAP_Runtime* runtime = OSAP_Runtime::getInstance();
+  for(uint8_t s = 0; s < OSAP_CONFIG_ONEPIPE_MAX_SUBSCRIBERS; s ++){
+    if(subscribers[s].active && !runtime->isFirstHopOpen(&(subscribers[s].route))){
+      subscribers[s].active = false;
+    }
+  }
+  // each subscriber goes from its own place in the ring, taking turns for stack space,
+  boolean sent = true;
+  while(sent){
+    sent = false;
+    for(uint8_t s = 0; s < OSAP_CONFIG_ONEPIPE_MAX_SUBSCRIBERS; s ++){
+      OnePipeSubscriber* sub = &(subscribers[s]);
+      if(!sub->active || sub->seq == tailSeq + ringCount) continue;
+      if(!clearToSend()) break;
+      sendTo(sub);
+      sent = true;
+    }
+  }
+  // and what's been to everyone is done w/,
+  ringRelease();
+}
@@ -1,26 +1,64 @@
-// data send-er, one-sided, one-channeled 
+// data send-er, one-sided, one-channeled
 
 #ifndef PORT_ONE_PIPE_H_
 #define PORT_ONE_PIPE_H_
 
 #include "../structure/ports.h"
 
+// listeners subscribe w/ a setup, and can have many at once (see OSAP_CONFIG_ONEPIPE_MAX_SUBSCRIBERS)
 #define PONEPIPE_SETUP 44
-#define PONEPIPE_SETUP_RES 45 
-#define PONEPIPE_MSG 77 
+#define PONEPIPE_SETUP_RES 45
+// and leave w/ this, or by going away: those whose route's first hop closes are dropped,
+#define PONEPIPE_TEARDOWN 46
+// (retired) one sample per packet,
+#define PONEPIPE_MSG 77
+// samples are buffered, and go out as many-per-packet,
+// | PONEPIPE_MSGS | SEQ:4 | N | (LEN | SAMPLE) * N |
+// where SEQ counts samples written, and is the first one's, so listeners can count gaps
+#define PONEPIPE_MSGS 78
 #define PONEPIPE_NAME_MAX_CHARS 32
 
+typedef struct OnePipeSubscriber {
+  boolean active = false;
+  uint16_t port = 0;
+  Route route;
+  // where they're at in the ring: the next sample to go to them, and its sequence number,
+  size_t cursor = 0;
+  uint32_t seq = 0;
+} OnePipeSubscriber;
+
 class OSAP_Port_OnePipe : public VPort {
   public:
     OSAP_Port_OnePipe(const char* _name);
     void onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) override;
-    // yarp yarp 
-    void write(uint8_t* data, size_t len);
+    const char* getName(uint8_t i) override;
+    // flushes what's buffered, whenever we're clear,
+    void loop(void) override;
+    // yarp yarp: samples are buffered (see OSAP_CONFIG_ONEPIPE_RING_SIZE), and when it's full,
+    // the oldest ones are dropped to make room, returns false if this one is too large to ever send
+    boolean write(uint8_t* data, size_t len);
+    // samples dropped so far,
+    uint32_t samplesDropped = 0;
   private:
     char name[PONEPIPE_NAME_MAX_CHARS];
-    uint16_t upPort = 0;
-    Route upRoute;
-    uint8_t outBuffer[OSAP_CONFIG_PACKET_MAX_SIZE];
+    OnePipeSubscriber subscribers[OSAP_CONFIG_ONEPIPE_MAX_SUBSCRIBERS];
+    OnePipeSubscriber* findSubscriber(Route* route, uint16_t port);
+    // samples, as | LEN | SAMPLE |, oldest at the tail, which stays put until every subscriber 
+    // has been sent past it: there's no other buffer, each packet is built in VPort::_payload 
+    uint8_t ring[OSAP_CONFIG_ONEPIPE_RING_SIZE];
+    size_t ringHead = 0;
+    size_t ringTail = 0;
+    size_t ringUsed = 0;
+    size_t ringCount = 0;
+    // the sequence number of the sample at the tail,
+    uint32_t tailSeq = 0;
+    void ringCopyOut(size_t at, uint8_t* dest, size_t len);
+    void ringPop(void);
+    // drops samples every subscriber has had,
+    void ringRelease(void);
+    // packs as many samples as fit on this subscriber's route, from its cursor, and sends them,
+    void sendTo(OnePipeSubscriber* sub);
+    void flush(void);
 };
 
-#endif 
\ No newline at end of file
+#endif
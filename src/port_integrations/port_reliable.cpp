@@ -0,0 +1,255 @@
+// reliable, in-order streams between two ports
+
+#include "port_reliable.h"
+#include "../utils/serializers.h"
+#include "../utils/log.h"
+
+static_assert(OSAP_CONFIG_RELIABLE_WINDOW <= 32, "OSAP_CONFIG_RELIABLE_WINDOW must be 32 or fewer (see the SACK bits)");
+// so that seq % WINDOW carries on across the uint16 wrap,
+static_assert((OSAP_CONFIG_RELIABLE_WINDOW & (OSAP_CONFIG_RELIABLE_WINDOW - 1)) == 0, "OSAP_CONFIG_RELIABLE_WINDOW must be a power of two");
+
+// senders are who they are by port and path: another host w/ the same port index mustn't
+// ack our stream, or write into the one we're receiving,
+static boolean reliableSamePath(Route* a, Route* b){
+  if(a->encodedPathLen != b->encodedPathLen) return false;
+  return memcmp(a->encodedPath, b->encodedPath, a->encodedPathLen) == 0;
+}
+
+OSAP_Port_Reliable::OSAP_Port_Reliable(
+  const char* _name,
+  void (*_onMessage)(uint8_t* data, size_t len)
+  ) : VPort(OSAP_Runtime::getInstance())
+{
+  // the name should be a literal, we keep the pointer,
+  name = _name;
+  onMessage = _onMessage;
+  typeKey = PTYPEKEY_RELIABLE;
+}
+
+const char* OSAP_Port_Reliable::getName(uint8_t i){
+  return (i == 0) ? name : nullptr;
+}
+
+// ---------------------------------------------- Sending
+
+void OSAP_Port_Reliable::connect(Route* route, uint16_t port){
+  txRoute = *route;
+  txPort = port;
+  txOpen = true;
+  txConnected = false;
+  // new streams start somewhere new, so that stragglers from an old one don't land in it,
+  txBase = txNext = txNext + OSAP_CONFIG_RELIABLE_WINDOW * 2;
+  synTries = 0;
+  rto = OSAP_CONFIG_RELIABLE_RTO_INITIAL_MS;
+  srtt8 = 0;
+  rttvar4 = 0;
+}
+
+boolean OSAP_Port_Reliable::isConnected(void){
+  return txConnected;
+}
+
+uint16_t OSAP_Port_Reliable::inFlight(void){
+  return txNext - txBase;
+}
+
+boolean OSAP_Port_Reliable::clearToWrite(void){
+  return txOpen && inFlight() < OSAP_CONFIG_RELIABLE_WINDOW;
+}
+
+boolean OSAP_Port_Reliable::write(uint8_t* data, size_t len){
+  if(!clearToWrite()) return false;
+  if(len > OSAP_CONFIG_RELIABLE_MAX_PAYLOAD || len + PREL_HEADER_LEN > txRoute.maxPayload()){
+    OSAP_LOG(LOGCODE_OVERSIZE_PORT_WRITE, len);
+    return false;
+  }
+  // it goes out from the loop, as soon as we're connected and clear,
+  ReliableTxSlot* slot = &(txSlots[txNext % OSAP_CONFIG_RELIABLE_WINDOW]);
+  memcpy(slot->data, data, len);
+  slot->len = len;
+  slot->tries = 0;
+  slot->sacked = false;
+  txNext ++;
+  return true;
+}
+
+uint32_t OSAP_Port_Reliable::getSRTT(void){
+  return srtt8 / 8;
+}
+
+void OSAP_Port_Reliable::txReset(uint8_t reason){
+  OSAP_LOG(LOGCODE_PREL_RESET, reason);
+  txOpen = false;
+  txConnected = false;
+  txBase = txNext;
+}
+
+void OSAP_Port_Reliable::rttSample(uint32_t rtt){
+  if(srtt8 == 0){
+    srtt8 = rtt * 8;
+    rttvar4 = rtt * 2;
+  } else {
+    // srtt += (rtt - srtt) / 8, rttvar += (|rtt - srtt| - rttvar) / 4,
+    int32_t err = (int32_t)rtt - (int32_t)(srtt8 / 8);
+    srtt8 += err;
+    if(err < 0) err = -err;
+    rttvar4 = rttvar4 + err - rttvar4 / 4;
+  }
+  rto = srtt8 / 8 + rttvar4;
+  if(rto < OSAP_CONFIG_RELIABLE_RTO_MIN_MS) rto = OSAP_CONFIG_RELIABLE_RTO_MIN_MS;
+  if(rto > OSAP_CONFIG_RELIABLE_RTO_MAX_MS) rto = OSAP_CONFIG_RELIABLE_RTO_MAX_MS;
+}
+
+void OSAP_Port_Reliable::onAck(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort, uint32_t now){
+  if(len < 7 || !txOpen) return;
+  if(sourcePort != txPort || !reliableSamePath(sourceRoute, &txRoute)) return;
+  uint16_t next = serializers_readUint16(data, 1);
+  uint32_t sack = (uint32_t)data[3] | ((uint32_t)data[4] << 8) | ((uint32_t)data[5] << 16) | ((uint32_t)data[6] << 24);
+  // the syn's ack,
+  if(!txConnected){
+    if(next != txBase) return;
+    txConnected = true;
+    if(synTries == 1) rttSample(now - synSentAt);
+    return;
+  }
+  // ignore stale (or nonsense) acks,
+  uint16_t advance = next - txBase;
+  if(advance > inFlight()) return;
+  // everything before next has arrived,
+  for(uint16_t a = 0; a < advance; a ++){
+    ReliableTxSlot* slot = &(txSlots[(uint16_t)(txBase + a) % OSAP_CONFIG_RELIABLE_WINDOW]);
+    if(slot->tries == 1) rttSample(now - slot->sentAt);
+  }
+  txBase = next;
+  // and these are held on the other side, out of order,
+  for(uint8_t b = 0; b < 32; b ++){
+    if(!(sack & ((uint32_t)1 << b))) continue;
+    uint16_t seq = next + 1 + b;
+    if((uint16_t)(seq - txBase) >= inFlight()) break;
+    txSlots[seq % OSAP_CONFIG_RELIABLE_WINDOW].sacked = true;
+  }
+}
+
+void OSAP_Port_Reliable::loop(void){
+  if(!txOpen) return;
+  uint32_t now = millis();
+  if(!OSAP_Runtime::getInstance()->isFirstHopOpen(&txRoute)){
+    txReset(PREL_RESET_ROUTE);
+    return;
+  }
+  // open the stream, re-trying w/ the same timeout as data,
+  if(!txConnected){
+    if(synTries > 0 && now - synSentAt < rto) return;
+    if(synTries >= OSAP_CONFIG_RELIABLE_MAX_TRIES){
+      txReset(PREL_RESET_TRIES);
+      return;
+    }
+    if(!clearToSend()) return;
+    _payload[0] = PREL_SYN;
+    uint16_t wptr = 1;
+    serializers_writeUint16(_payload, &wptr, txBase);
+    send(_payload, wptr, &txRoute, txPort);
+    if(synTries > 0 && rto < OSAP_CONFIG_RELIABLE_RTO_MAX_MS) rto *= 2;
+    synSentAt = now;
+    synTries ++;
+    return;
+  }
+  // then, in order: first sends, and re-sends of those that have timed out,
+  boolean backedOff = false;
+  for(uint16_t seq = txBase; seq != txNext; seq ++){
+    ReliableTxSlot* slot = &(txSlots[seq % OSAP_CONFIG_RELIABLE_WINDOW]);
+    if(slot->sacked) continue;
+    if(slot->tries > 0 && now - slot->sentAt < rto) continue;
+    if(slot->tries >= OSAP_CONFIG_RELIABLE_MAX_TRIES){
+      txReset(PREL_RESET_TRIES);
+      return;
+    }
+    if(!clearToSend()) return;
+    if(slot->tries > 0){
+      retransmits ++;
+      // one back-off per round of timeouts,
+      if(!backedOff && rto < OSAP_CONFIG_RELIABLE_RTO_MAX_MS){
+        rto *= 2;
+        if(rto > OSAP_CONFIG_RELIABLE_RTO_MAX_MS) rto = OSAP_CONFIG_RELIABLE_RTO_MAX_MS;
+        backedOff = true;
+      }
+    }
+    uint16_t wptr = 0;
+    _payload[wptr ++] = PREL_DATA;
+    serializers_writeUint16(_payload, &wptr, seq);
+    memcpy(&(_payload[wptr]), slot->data, slot->len);
+    send(_payload, wptr + slot->len, &txRoute, txPort);
+    slot->sentAt = now;
+    slot->tries ++;
+  }
+}
+
+// ---------------------------------------------- Receiving
+
+void OSAP_Port_Reliable::ack(Route* sourceRoute, uint16_t sourcePort){
+  // if we can't, the sender's timeout covers it, and the next ack is cumulative,
+  if(!clearToSend()) return;
+  uint32_t sack = 0;
+  for(uint8_t b = 0; b + 1 < OSAP_CONFIG_RELIABLE_WINDOW; b ++){
+    if(rxSlots[(uint16_t)(rxNext + 1 + b) % OSAP_CONFIG_RELIABLE_WINDOW].held) sack |= (uint32_t)1 << b;
+  }
+  uint16_t wptr = 0;
+  _payload[wptr ++] = PREL_ACK;
+  serializers_writeUint16(_payload, &wptr, rxNext);
+  serializers_writeUint32(_payload, &wptr, sack);
+  send(_payload, wptr, sourceRoute, sourcePort);
+}
+
+void OSAP_Port_Reliable::onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort){
+  switch(data[0]){
+    case PREL_SYN:
+      {
+        if(len < PREL_HEADER_LEN) break;
+        // a new stream replaces the last one, a repeat (our ack was slow, or lost) just re-acks, 
+        // repeats can't arrive after the stream's data, since routes deliver in order and data only follows the ack,
+        uint16_t seq = serializers_readUint16(data, 1);
+        if(!rxOpen || rxPort != sourcePort || !reliableSamePath(sourceRoute, &rxRoute) || rxNext != seq){
+          rxOpen = true;
+          rxRoute = *sourceRoute;
+          rxPort = sourcePort;
+          rxNext = seq;
+          for(uint8_t s = 0; s < OSAP_CONFIG_RELIABLE_WINDOW; s ++) rxSlots[s].held = false;
+        }
+        ack(sourceRoute, sourcePort);
+      }
+      break;
+    case PREL_DATA:
+      {
+        if(len < PREL_HEADER_LEN || !rxOpen || sourcePort != rxPort || !reliableSamePath(sourceRoute, &rxRoute)) break;
+        uint16_t seq = serializers_readUint16(data, 1);
+        uint16_t ahead = seq - rxNext;
+        if(ahead == 0){
+          // in order: hand it up, and any held behind it,
+          rxNext ++;
+          if(onMessage != nullptr) onMessage(&(data[PREL_HEADER_LEN]), len - PREL_HEADER_LEN);
+          ReliableRxSlot* held = &(rxSlots[rxNext % OSAP_CONFIG_RELIABLE_WINDOW]);
+          while(held->held){
+            held->held = false;
+            rxNext ++;
+            if(onMessage != nullptr) onMessage(held->data, held->len);
+            held = &(rxSlots[rxNext % OSAP_CONFIG_RELIABLE_WINDOW]);
+          }
+        } else if(ahead < OSAP_CONFIG_RELIABLE_WINDOW && len - PREL_HEADER_LEN <= OSAP_CONFIG_RELIABLE_MAX_PAYLOAD){
+          // early: hold it,
+          ReliableRxSlot* slot = &(rxSlots[seq % OSAP_CONFIG_RELIABLE_WINDOW]);
+          slot->held = true;
+          slot->len = len - PREL_HEADER_LEN;
+          memcpy(slot->data, &(data[PREL_HEADER_LEN]), slot->len);
+        }
+        // and duplicates (behind rxNext) are only re-acked,
+        ack(sourceRoute, sourcePort);
+      }
+      break;
+    case PREL_ACK:
+      onAck(data, len, sourceRoute, sourcePort, millis());
+      break;
+    default:
+      OSAP_LOG(LOGCODE_PORT_BAD_KEY, (typeKey << 8) | data[0]);
+      break;
+  }
+}
@@ -0,0 +1,103 @@
+// reliable, in-order streams between two ports
+
+#ifndef PORT_RELIABLE_H_
+#define PORT_RELIABLE_H_
+
+#include "../structure/ports.h"
+
+// a sender connects to another reliable port, and then writes: messages arrive at the
+// other end's onMessage in order, exactly once, or the stream is reset (and logged),
+// w/ up to OSAP_CONFIG_RELIABLE_WINDOW messages in flight at once,
+//
+// OSAP_Port_Reliable stream("encoders");
+// stream.connect(&route, 1);
+// ...
+// if(stream.clearToWrite()) stream.write(data, len);
+//
+// | PREL_SYN | SEQ:2 |          -> | PREL_ACK | NEXT:2 | SACK:4 |  starts a stream at SEQ
+// | PREL_DATA | SEQ:2 | DATA |  -> | PREL_ACK | NEXT:2 | SACK:4 |
+// acks are cumulative: NEXT is the first seq not yet received, and SACK's bit i is set
+// if NEXT + 1 + i has been received (and is held, out of order), so that only holes
+// are re-sent, which happens once a packet is unacked for longer than the retransmit timeout,
+// itself tracking the measured round trip time (w/ Karn's rule: re-sent packets aren't timed)
+#define PREL_SYN 1
+#define PREL_DATA 2
+#define PREL_ACK 3
+
+#define PREL_HEADER_LEN 3
+
+// reasons a stream was reset, for LOGCODE_PREL_RESET,
+#define PREL_RESET_TRIES 1
+#define PREL_RESET_ROUTE 2
+
+typedef struct ReliableTxSlot {
+  uint16_t len = 0;
+  uint32_t sentAt = 0;
+  uint8_t tries = 0;
+  boolean sacked = false;
+  uint8_t data[OSAP_CONFIG_RELIABLE_MAX_PAYLOAD];
+} ReliableTxSlot;
+
+typedef struct ReliableRxSlot {
+  boolean held = false;
+  uint16_t len = 0;
+  uint8_t data[OSAP_CONFIG_RELIABLE_MAX_PAYLOAD];
+} ReliableRxSlot;
+
+class OSAP_Port_Reliable : public VPort {
+  public:
+    // -------------------------------- Constructors
+    OSAP_Port_Reliable(const char* _name, void (*_onMessage)(uint8_t* data, size_t len) = nullptr);
+
+    // -------------------------------- Sending
+    // starts a stream to another reliable port, dropping any underway,
+    void connect(Route* route, uint16_t port);
+    boolean isConnected(void);
+    // true if there's room in the window for another write,
+    boolean clearToWrite(void);
+    // queues a message, returning false if the window is full, or it's larger than
+    // OSAP_CONFIG_RELIABLE_MAX_PAYLOAD (or the route's segment),
+    boolean write(uint8_t* data, size_t len);
+    // messages written but not yet acked,
+    uint16_t inFlight(void);
+
+    // -------------------------------- Stats
+    uint32_t retransmits = 0;
+    // the current retransmit timeout, and the smoothed round trip, in ms
+    uint32_t rto = OSAP_CONFIG_RELIABLE_RTO_INITIAL_MS;
+    uint32_t getSRTT(void);
+
+    // -------------------------------- OSAP-Facing API
+    void onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) override;
+    const char* getName(uint8_t i) override;
+    void loop(void) override;
+
+  private:
+    const char* name;
+    void (*onMessage)(uint8_t* data, size_t len) = nullptr;
+    // the sending half,
+    boolean txOpen = false;
+    boolean txConnected = false;
+    Route txRoute;
+    uint16_t txPort = 0;
+    uint16_t txBase = 0;
+    uint16_t txNext = 0;
+    uint32_t synSentAt = 0;
+    uint8_t synTries = 0;
+    // jacobson / karels, in ms scaled by 8 and 4, (0 until we have a sample)
+    uint32_t srtt8 = 0;
+    uint32_t rttvar4 = 0;
+    ReliableTxSlot txSlots[OSAP_CONFIG_RELIABLE_WINDOW];
+    void txReset(uint8_t reason);
+    void onAck(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort, uint32_t now);
+    void rttSample(uint32_t rtt);
+    // and the receiving one, from one sender (port and path) at a time,
+    boolean rxOpen = false;
+    Route rxRoute;
+    uint16_t rxPort = 0;
+    uint16_t rxNext = 0;
+    ReliableRxSlot rxSlots[OSAP_CONFIG_RELIABLE_WINDOW];
+    void ack(Route* sourceRoute, uint16_t sourcePort);
+};
+
+#endif
@@ -6,14 +6,12 @@
 #include "../structure/ports.h"
 #include "../utils/template_serializers.h"
 #include "./port_rpc_helpers.h"
+#include "../utils/log.h"
+#include "../runtime/rpc_pending.h"
+#include "../runtime/subscriptions.h"
 #include <tuple>
 
-#define PRPC_KEY_SIGREQ 1
-#define PRPC_KEY_SIGRES 2
-#define PRPC_KEY_FUNCCALL 3
-#define PRPC_KEY_FUNCRETURN 4
-
-// see ./port_rpc_helpers.h for much of the wizardry required, 
+// msg keys are in ./port_rpc_helpers.h, as is much of the wizardry required, 
 // ------------------------------------ the actual class 
 template <typename Func>
 class OSAP_Port_RPC;
@@ -25,7 +23,8 @@ class OSAP_Port_RPC<Ret(*)(Args...)> : public VPort {
     using ResultType = typename ReturnType<Ret>::Type;
 
     // -------------------------------- Constructors 
-    // base constructor 
+    // base constructor, the names should be literals: we keep pointers to them, not copies, 
+    // and assemble the signature from them on each PRPC_KEY_SIGREQ, 
     OSAP_Port_RPC(
       Ret(*funcPtr)(Args...), const char* functionName, const char* argNames
     ) : VPort(OSAP_Runtime::getInstance())
@@ -34,42 +33,41 @@ class OSAP_Port_RPC<Ret(*)(Args...)> : public VPort {
       typeKey = PTYPEKEY_AUTO_RPC_IMPLEMENTER;
       // stash names and the functo 
       _funcPtr = funcPtr;
-      strncpy(_functionName, functionName, PRPC_FUNCNAME_MAX_CHAR);
-      // count args using ... pattern; this is odd to me:
-      ((_numArgs ++, sizeof(Args)), ...);
-      // and then read-while-copying, and throw some error if we don't have 
-      // the right count of args... 
-      argSplitter(argNames, _argNames);
+      _functionName = functionName;
+      _argNames = argNames;
     }
     // deferring constructor for whence we have no args, 
     OSAP_Port_RPC(
       Ret(*funcPtr)(Args...), const char* functionName
     ) : OSAP_Port_RPC(funcPtr, functionName, "") {}
+    // or w/ the signature built at compile time, see OSAP_PORT_RPC() below, 
+    template <size_t N>
+    OSAP_Port_RPC(
+      Ret(*funcPtr)(Args...), const char* functionName, const RPCSignature<N>& signature
+    ) : OSAP_Port_RPC(funcPtr, functionName, "") {
+      _signature = signature.bytes;
+      _signatureLen = signature.len;
+    }
   
     // -------------------------------- OSAP-Facing API
+    // we report the function name, the signature is still a PRPC_KEY_SIGREQ away 
+    const char* getName(uint8_t i) override {
+      return (i == 0) ? _functionName : nullptr;
+    }
+
     // override the packet handler, 
     void onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) override {
+      // everything carries | KEY | ID |, at least, 
+      if(len < 2){
+        OSAP_LOG(LOGCODE_RPC_BAD_ARGS, 0);
+        return;
+      }
       switch(data[0]){
         case PRPC_KEY_SIGREQ:
           {
-            // write response key and msg id 
-            size_t wptr = 0;
-            _payload[wptr ++] = PRPC_KEY_SIGRES;
-            _payload[wptr ++] = data[1];
-            // write return type, arg-count, args, 
-            _payload[wptr ++] = getTypeKey<Ret>();
-            _payload[wptr ++] = _numArgs;
-            // add a type key to the payload for each arg in Args...
-            // this is a "fold expression" ... which is not available until c++17 
-            // instead, we could use recursive template expansions 
-            (..., (_payload[wptr++] = getTypeKey<Args>())); 
-            // now we want to sendy the names, 
-            // which will be str, str..., str 
-            serialize<char*>(_functionName, _payload, &wptr);
-            // wptr += 1;
-            for(uint8_t a = 0; a < _numArgs; a ++){
-              serialize<char *>(_argNames[a], _payload, &wptr);
-            }
+            // write response key, msg id, and the signature: straight from flash if we have it, 
+            size_t wptr = rpcSignatureReply<Ret(*)(Args...)>(data[1], _functionName, _argNames, _signature, _signatureLen, _payload, sourceRoute->maxPayload());
+            if(wptr == 0) break;
             // we are done, ship it back: 
             send(_payload, wptr, sourceRoute, sourcePort);
           }
@@ -81,58 +79,226 @@ class OSAP_Port_RPC<Ret(*)(Args...)> : public VPort {
             _payload[wptr ++] = PRPC_KEY_FUNCRETURN;
             _payload[wptr ++] = data[1];
             // we'll be reading starting at [2] in the packet, 
-            size_t rptr = 2;
-            // we have four cases to deal with: void-void, void-args, ret-void, ret-args, 
-            // another note on the compiler availability: `constexpr` is only available since c++17, 
-            // so it might be that we need to specialize templates for each case void-void...ret-args etc 
-            if constexpr (sizeof...(Args) == 0){
-              if constexpr (std::is_same<Ret, void>::value){
-                // we are void-void, 
-                _funcPtr();
-              } else {
-                // ret-void, 
-                resultStorage.result = _funcPtr();
-              }
-            } else {
-              // each of the following conditions has args, so deserialize those:
-              argStorage.tuple = deserializeArgs<Args...>(data, &rptr);
-              if constexpr (std::is_same<Ret, void>::value) {
-                // this is void-args, we use 'apply' but there is no storage of the return type
-                // note that std::apply is only available since c++17, so this would also require 
-                // rework, although (since tuples are available since c++14), it should be possible 
-                // again using recursive template expansion... 
-                std::apply(_funcPtr, argStorage.tuple);
-              } else {
-                // this is ret-args, we use 'apply' and stash the result, 
-                resultStorage.result = std::apply(_funcPtr, argStorage.tuple);
-              }               
+            size_t maxLen = sourceRoute->maxPayload();
+            if(maxLen < wptr) break;
+            size_t retLen = 0;
+            if(!rpcInvoke<Ret, Args...>(_funcPtr, &(data[2]), len - 2, &(_payload[wptr]), maxLen - wptr, &retLen)){
+              OSAP_LOG(LOGCODE_RPC_BAD_ARGS, 0);
+              break;
             }
-            // in both cases where we have some result, we serialize:
-            if constexpr (!(std::is_same<Ret, void>::value)){
-              serialize<Ret>(resultStorage.result, _payload, &wptr);
+            if(retLen > maxLen - wptr){
+              OSAP_LOG(LOGCODE_RPC_RESULT_TOO_LARGE, 0);
+              break;
             }
+            wptr += retLen;
             // currently void returners simply donot serialize anything on the way up,  
             // so that'd be it, we can sendy:
             send(_payload, wptr, sourceRoute, sourcePort);
           }
           break;
+        case PRPC_KEY_BATCHCALL:
+          {
+            // the same call, many times over, w/ all of the results in one reply, 
+            size_t wptr = rpcBatch(data, len, _payload, sourceRoute->maxPayload(), false, 
+              [this](uint8_t index, uint8_t* args, size_t argsLen, uint8_t* ret, size_t retMax, size_t* retLen){
+                return rpcInvoke<Ret, Args...>(_funcPtr, args, argsLen, ret, retMax, retLen);
+              });
+            if(wptr == 0) break;
+            send(_payload, wptr, sourceRoute, sourcePort);
+          }
+          break;
+        case PRPC_KEY_SUBSCRIBE:
+          // the same call, made by us on the caller's behalf, see sample() 
+          _payload[0] = PRPC_KEY_SUBRES;
+          _payload[1] = data[1];
+          _payload[2] = subscriptionOpen(this, PRPC_KEY_PUSH, data, len, sourceRoute, sourcePort) ? 1 : 0;
+          send(_payload, 3, sourceRoute, sourcePort);
+          break;
+        case PRPC_KEY_UNSUBSCRIBE:
+          subscriptionClose(this, data[1], sourceRoute, sourcePort);
+          break;
         default:
-          OSAP_Runtime::error("bad onPacket key to PRPC");
+          OSAP_LOG(LOGCODE_PORT_BAD_KEY, (typeKey << 8) | data[0]);
           break;
       }
     }
 
+    // subscriptions call w/ the args they were opened with, 
+    boolean sample(uint8_t* args, size_t argsLen, uint8_t* dest, size_t maxLen, size_t* len) override {
+      return rpcInvoke<Ret, Args...>(_funcPtr, args, argsLen, dest, maxLen, len);
+    }
+
   private: 
     // the pointer, etc... 
     Ret(*_funcPtr)(Args...) = nullptr;
-    uint8_t _numArgs = 0;
-    char _functionName[PRPC_FUNCNAME_MAX_CHAR];
-    char _argNames[PRPC_MAX_ARGS][PRPC_ARGNAME_MAX_CHAR];
-    // we allocate storage for the function results and args here to avoid stack overflow, 
-    // and these both use template helpers that simply store nothing when no args or no return type is present 
-    ResultStorage<Ret, std::is_same<Ret, void>::value> resultStorage;
-    ArgStorage<Args...> argStorage;
+    const char* _functionName = nullptr;
+    const char* _argNames = nullptr;
+    const uint8_t* _signature = nullptr;
+    size_t _signatureLen = 0;
+};
+
+// ------------------------------------ async functions 
+// a function that starts something long (a homing move, an adc burst...) shouldn't hold up the 
+// runtime until it's done, so it can take a completion as its first arg, return right away, 
+// and complete the call later, i.e. from the sketch's loop: 
+//
+// RPCDeferred<int32_t> homing;
+// void home(RPCDeferred<int32_t> done, float rate){ startHoming(rate); homing = done; }
+// OSAP_PORT_RPC(homePort, home, "rate");
+// ... 
+// if(homing.isPending() && homingIsDone()) homing.complete(stepsTaken);
+//
+// the runtime keeps the call's reverse route and msg id (see runtime/rpc_pending.h), and callers 
+// see the same | PRPC_KEY_FUNCRETURN | MSGID | RESULT | reply as from any other function, only later, 
+// calls that aren't completed within the port's .timeout are dropped w/o a reply 
+
+class RPCCompletion {
+  public:
+    // true until it's completed, cancelled, or times out, 
+    boolean isPending(void){
+      return rpcPendingGet(slot, generation) != nullptr;
+    }
+    // lets the call go w/o a reply, 
+    void cancel(void){
+      if(isPending()) rpcPendingClose(slot);
+    }
+
+  protected:
+    uint8_t slot = RPC_PENDING_NONE;
+    uint8_t generation = 0;
+
+    template <typename T>
+    boolean reply(const T& result){
+      RPCPending* pending = rpcPendingGet(slot, generation);
+      if(pending == nullptr) return false;
+      // we don't drop results for want of stack: the caller can try again, 
+      if(!pending->vport->clearToSend()) return false;
+      uint8_t* payload = VPort::_payload;
+      size_t maxLen = pending->route.maxPayload();
+      size_t wptr = 0;
+      payload[wptr ++] = PRPC_KEY_FUNCRETURN;
+      payload[wptr ++] = pending->msgID;
+      if constexpr (!std::is_same<T, Unit>::value){
+        serialize<T>(result, payload, &wptr, maxLen);
+      }
+      if(wptr > maxLen){
+        OSAP_LOG(LOGCODE_RPC_RESULT_TOO_LARGE, 0);
+      } else {
+        pending->vport->send(payload, wptr, &(pending->route), pending->destinationPort);
+      }
+      rpcPendingClose(slot);
+      return wptr <= maxLen;
+    }
+};
+
+template <typename Ret>
+class RPCDeferred : public RPCCompletion {
+  public:
+    RPCDeferred(void){}
+    RPCDeferred(uint8_t _slot, uint8_t _generation){
+      slot = _slot;
+      generation = _generation;
+    }
+    // replies, returning false if the call is gone (or the result didn't fit), 
+    // or if the stack is full just now, in which case it's still pending: try again, 
+    boolean complete(const Ret& result){
+      return reply<Ret>(result);
+    }
+};
+
+template <>
+class RPCDeferred<void> : public RPCCompletion {
+  public:
+    RPCDeferred(void){}
+    RPCDeferred(uint8_t _slot, uint8_t _generation){
+      slot = _slot;
+      generation = _generation;
+    }
+    boolean complete(void){
+      return reply<Unit>(unit);
+    }
+};
+
+template <typename Ret, typename... Args>
+class OSAP_Port_RPC<void(*)(RPCDeferred<Ret>, Args...)> : public VPort {
+  public:
+    // -------------------------------- Constructors, as above 
+    OSAP_Port_RPC(
+      void(*funcPtr)(RPCDeferred<Ret>, Args...), const char* functionName, const char* argNames
+    ) : VPort(OSAP_Runtime::getInstance())
+    {
+      typeKey = PTYPEKEY_AUTO_RPC_IMPLEMENTER;
+      _funcPtr = funcPtr;
+      _functionName = functionName;
+      _argNames = argNames;
+    }
+    OSAP_Port_RPC(
+      void(*funcPtr)(RPCDeferred<Ret>, Args...), const char* functionName
+    ) : OSAP_Port_RPC(funcPtr, functionName, "") {}
+    template <size_t N>
+    OSAP_Port_RPC(
+      void(*funcPtr)(RPCDeferred<Ret>, Args...), const char* functionName, const RPCSignature<N>& signature
+    ) : OSAP_Port_RPC(funcPtr, functionName, "") {
+      _signature = signature.bytes;
+      _signatureLen = signature.len;
+    }
+
+    // ms before an uncompleted call is dropped, 
+    uint32_t timeout = OSAP_CONFIG_RPC_PENDING_TIMEOUT_MS;
+
+    // -------------------------------- OSAP-Facing API
+    const char* getName(uint8_t i) override {
+      return (i == 0) ? _functionName : nullptr;
+    }
+
+    void onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) override {
+      if(len < 2){
+        OSAP_LOG(LOGCODE_RPC_BAD_ARGS, 0);
+        return;
+      }
+      switch(data[0]){
+        case PRPC_KEY_SIGREQ:
+          {
+            size_t wptr = rpcSignatureReply<void(*)(RPCDeferred<Ret>, Args...)>(data[1], _functionName, _argNames, _signature, _signatureLen, _payload, sourceRoute->maxPayload());
+            if(wptr == 0) break;
+            send(_payload, wptr, sourceRoute, sourcePort);
+          }
+          break;
+        case PRPC_KEY_FUNCCALL:
+          {
+            // hold the route and msg id, or drop the call if we can't: the caller will time out, 
+            uint8_t generation = 0;
+            uint8_t slot = rpcPendingOpen(this, sourceRoute, sourcePort, data[1], timeout, &generation);
+            if(slot == RPC_PENDING_NONE) break;
+            // and start it, nothing is written here: the reply comes w/ completion, 
+            RPCDeferred<Ret> done(slot, generation);
+            size_t retLen = 0;
+            if(!rpcInvoke<void, Args...>([&](auto&... args){ _funcPtr(done, args...); }, &(data[2]), len - 2, nullptr, 0, &retLen)){
+              OSAP_LOG(LOGCODE_RPC_BAD_ARGS, 0);
+              rpcPendingClose(slot);
+            }
+          }
+          break;
+        // async calls aren't batched, since the batch's reply would have to wait on all of them, 
+        default:
+          OSAP_LOG(LOGCODE_PORT_BAD_KEY, (typeKey << 8) | data[0]);
+          break;
+      }
+    }
+
+  private: 
+    void(*_funcPtr)(RPCDeferred<Ret>, Args...) = nullptr;
+    const char* _functionName = nullptr;
+    const char* _argNames = nullptr;
+    const uint8_t* _signature = nullptr;
+    size_t _signatureLen = 0;
 };
 
+// declares `port` w/ its PRPC_KEY_SIGRES reply assembled at compile time, i.e. 
+// OSAP_PORT_RPC(speedPort, setSpeed, "rpm, accel"); 
+#define OSAP_PORT_RPC(port, func, argNames) \
+  constexpr auto port##_signature = rpcSignature<decltype(&func)>(#func, argNames); \
+  static_assert(port##_signature.len <= OSAP_CONFIG_PACKET_MAX_SIZE - 2, #port ": signature won't fit in a packet"); \
+  OSAP_Port_RPC<decltype(&func)> port(&func, #func, port##_signature)
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,140 @@
+// many rpc functions behind one port
+
+#include "port_rpc_dispatch.h"
+#include "../utils/log.h"
+#include "../runtime/subscriptions.h"
+
+OSAP_Port_RPCDispatch::OSAP_Port_RPCDispatch(const char* _name, const RPCFunction* _table, uint8_t _count) :
+  VPort(OSAP_Runtime::getInstance())
+{
+  typeKey = PTYPEKEY_AUTO_RPC_DISPATCHER;
+  // the name and table are (flash-resident) literals, so we don't copy them,
+  name = _name;
+  table = _table;
+  count = _count;
+}
+
+const char* OSAP_Port_RPCDispatch::getName(uint8_t i){
+  return (i == 0) ? name : nullptr;
+}
+
+void OSAP_Port_RPCDispatch::onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort){
+  size_t maxLen = sourceRoute->maxPayload();
+  size_t wptr = 0;
+  // everything carries | KEY | ID |, and the table, signature and call requests an index after that, 
+  if(len < 2) return;
+  if(len < 3 && (data[0] == PRPC_KEY_TABLEREQ || data[0] == PRPC_KEY_SIGREQ || data[0] == PRPC_KEY_FUNCCALL)){
+    OSAP_LOG(LOGCODE_RPC_BAD_ARGS, 0);
+    return;
+  }
+  // replies' heads are up to five bytes, (| TABLERES | ID | COUNT | START | N |) so routes w/o 
+  // room for that get nothing, but for unsubscribes, which aren't replied to 
+  if(maxLen < 5 && data[0] != PRPC_KEY_UNSUBSCRIBE) return;
+  switch(data[0]){
+    case PRPC_KEY_TABLEREQ:
+      {
+        // as many as fit, from the start,
+        uint8_t start = data[2];
+        _payload[wptr ++] = PRPC_KEY_TABLERES;
+        _payload[wptr ++] = data[1];
+        _payload[wptr ++] = count;
+        size_t startPtr = wptr;
+        _payload[wptr ++] = start;
+        size_t nPtr = wptr ++;
+        uint8_t n = 0;
+        for(uint16_t i = start; i < count; i ++){
+          size_t sigLen = 0;
+          if(wptr + 1 < maxLen) sigLen = table[i].writeSignature(table[i].name, table[i].argNames, &(_payload[wptr + 1]), maxLen - wptr - 1);
+          if(sigLen == 0){
+            // an entry that doesn't fit in an otherwise-empty reply never will: skip it, 
+            // (moving START past it) rather than have the host ask for it forever 
+            if(n == 0){
+              OSAP_LOG(LOGCODE_RPC_SIG_SKIPPED, i);
+              _payload[startPtr] = i + 1;
+              continue;
+            }
+            break;
+          }
+          _payload[wptr] = i;
+          wptr += 1 + sigLen;
+          n ++;
+        }
+        _payload[nPtr] = n;
+        send(_payload, wptr, sourceRoute, sourcePort);
+      }
+      break;
+    case PRPC_KEY_SIGREQ:
+      {
+        uint8_t index = data[2];
+        if(index >= count){
+          OSAP_LOG(LOGCODE_RPC_BAD_INDEX, index);
+          break;
+        }
+        _payload[wptr ++] = PRPC_KEY_SIGRES;
+        _payload[wptr ++] = data[1];
+        _payload[wptr ++] = index;
+        wptr += table[index].writeSignature(table[index].name, table[index].argNames, &(_payload[wptr]), maxLen - wptr);
+        send(_payload, wptr, sourceRoute, sourcePort);
+      }
+      break;
+    case PRPC_KEY_FUNCCALL:
+      {
+        uint8_t index = data[2];
+        if(index >= count){
+          OSAP_LOG(LOGCODE_RPC_BAD_INDEX, index);
+          break;
+        }
+        _payload[wptr ++] = PRPC_KEY_FUNCRETURN;
+        _payload[wptr ++] = data[1];
+        _payload[wptr ++] = index;
+        // jump,
+        size_t retLen = 0;
+        if(!table[index].call(&(data[3]), len - 3, &(_payload[wptr]), maxLen - wptr, &retLen)){
+          OSAP_LOG(LOGCODE_RPC_BAD_ARGS, index);
+          break;
+        }
+        if(retLen > maxLen - wptr){
+          OSAP_LOG(LOGCODE_RPC_RESULT_TOO_LARGE, index);
+          break;
+        }
+        wptr += retLen;
+        send(_payload, wptr, sourceRoute, sourcePort);
+      }
+      break;
+    case PRPC_KEY_BATCHCALL:
+      {
+        // the same jumps, in order, w/ all of the results in one reply,
+        wptr = rpcBatch(data, len, _payload, maxLen, true, 
+          [this](uint8_t index, uint8_t* args, size_t argsLen, uint8_t* ret, size_t retMax, size_t* retLen){
+            if(index >= count){
+              OSAP_LOG(LOGCODE_RPC_BAD_INDEX, index);
+              return false;
+            }
+            return table[index].call(args, argsLen, ret, retMax, retLen);
+          });
+        send(_payload, wptr, sourceRoute, sourcePort);
+      }
+      break;
+    case PRPC_KEY_SUBSCRIBE:
+      _payload[wptr ++] = PRPC_KEY_SUBRES;
+      _payload[wptr ++] = data[1];
+      _payload[wptr ++] = subscriptionOpen(this, PRPC_KEY_PUSH, data, len, sourceRoute, sourcePort) ? 1 : 0;
+      send(_payload, wptr, sourceRoute, sourcePort);
+      break;
+    case PRPC_KEY_UNSUBSCRIBE:
+      subscriptionClose(this, data[1], sourceRoute, sourcePort);
+      break;
+    default:
+      OSAP_LOG(LOGCODE_PORT_BAD_KEY, (typeKey << 8) | data[0]);
+      break;
+  }
+}
+
+// subscriptions' args are | INDEX | ARGS |, 
+boolean OSAP_Port_RPCDispatch::sample(uint8_t* args, size_t argsLen, uint8_t* dest, size_t maxLen, size_t* len){
+  if(argsLen < 1 || args[0] >= count){
+    OSAP_LOG(LOGCODE_RPC_BAD_INDEX, argsLen < 1 ? 0 : args[0]);
+    return false;
+  }
+  return table[args[0]].call(&(args[1]), argsLen - 1, dest, maxLen, len);
+}
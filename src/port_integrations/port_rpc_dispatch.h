@@ -0,0 +1,90 @@
+// many rpc functions behind one port
+
+#ifndef PORT_RPC_DISPATCH_H_
+#define PORT_RPC_DISPATCH_H_
+
+#include "../structure/ports.h"
+#include "./port_rpc.h"
+#include "./port_rpc_helpers.h"
+
+// each OSAP_Port_RPC is a whole port, w/ its own names and storage in RAM,
+// a dispatcher instead serves a table of functions, built at compile time:
+//
+// int setCurrent(float amps){ ... }
+// void home(void){ ... }
+// constexpr RPCFunction motorFunctions[] = {
+//   OSAP_RPC_FUNCTION(setCurrent, "amps"),
+//   OSAP_RPC_FUNCTION(home, ""),
+// };
+// OSAP_Port_RPCDispatch motorRPC("motor", motorFunctions);
+//
+// and functions are called by their index in the table:
+// | PRPC_KEY_SIGREQ | MSGID | INDEX |  -> | PRPC_KEY_SIGRES | MSGID | INDEX | <signature> |
+// | PRPC_KEY_FUNCCALL | MSGID | INDEX | ARGS | -> | PRPC_KEY_FUNCRETURN | MSGID | INDEX | RESULT |
+// where the signature is as from OSAP_Port_RPC:
+// | RET_TYPE | NUM_ARGS | ARG_TYPES... | <name> | <arg names>... |
+// and all of the signatures can be had w/ one query, as many as fit per reply:
+// | PRPC_KEY_TABLEREQ | MSGID | START | -> | PRPC_KEY_TABLERES | MSGID | COUNT | START | N | (INDEX | <signature>) * N |
+// and calls (to any mix of functions) can be batched, see rpcBatch() in ./port_rpc_helpers.h
+// or subscribed to, w/ the INDEX as the first of the subscription's args, see runtime/subscriptions.h
+
+// ------------------------------------ the table entries
+
+typedef struct RPCFunction {
+  const char* name;
+  // comma-delimited, as w/ OSAP_Port_RPC,
+  const char* argNames;
+  // decodes args, calls, and writes the result, see rpcInvoke(),
+  boolean (*call)(uint8_t* args, size_t argsLen, uint8_t* ret, size_t retMax, size_t* retLen);
+  // writes the | <signature> | if it fits, returning its length, (see rpcSignatureWrite())
+  size_t (*writeSignature)(const char* name, const char* argNames, uint8_t* dest, size_t maxLen);
+} RPCFunction;
+
+// one of these is generated per function, and is the jump target,
+template <auto F>
+struct RPCThunk;
+
+template <typename Ret, typename... Args, Ret(*F)(Args...)>
+struct RPCThunk<F> {
+  static boolean call(uint8_t* args, size_t argsLen, uint8_t* ret, size_t retMax, size_t* retLen){
+    return rpcInvoke<Ret, Args...>(F, args, argsLen, ret, retMax, retLen);
+  }
+};
+
+// async functions need a port of their own (see ./port_rpc.h), 
+template <typename Ret, typename... Args, void(*F)(RPCDeferred<Ret>, Args...)>
+struct RPCThunk<F> {
+  static_assert(!std::is_same<Ret, Ret>::value, "async rpc functions can't be dispatched, use an OSAP_Port_RPC");
+  static boolean call(uint8_t* args, size_t argsLen, uint8_t* ret, size_t retMax, size_t* retLen){
+    return false;
+  }
+};
+
+// named for the function itself, or otherwise,
+#define OSAP_RPC_FUNCTION(func, argNames) \
+  RPCFunction{ #func, argNames, &RPCThunk<&func>::call, &rpcSignatureWrite<decltype(&func)> }
+#define OSAP_RPC_FUNCTION_NAMED(func, name, argNames) \
+  RPCFunction{ name, argNames, &RPCThunk<&func>::call, &rpcSignatureWrite<decltype(&func)> }
+
+// ------------------------------------ the port
+
+class OSAP_Port_RPCDispatch : public VPort {
+  public:
+    OSAP_Port_RPCDispatch(const char* _name, const RPCFunction* _table, uint8_t _count);
+    template <size_t N>
+    OSAP_Port_RPCDispatch(const char* _name, const RPCFunction (&_table)[N]) :
+      OSAP_Port_RPCDispatch(_name, _table, N) {
+      static_assert(N <= 255, "dispatchers hold at most 255 functions");
+    }
+    // we report the port's name, function names are a PRPC_KEY_TABLEREQ away
+    const char* getName(uint8_t i) override;
+    void onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) override;
+    boolean sample(uint8_t* args, size_t argsLen, uint8_t* dest, size_t maxLen, size_t* len) override;
+
+  private:
+    const char* name;
+    const RPCFunction* table;
+    uint8_t count;
+};
+
+#endif
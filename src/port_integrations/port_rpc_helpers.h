@@ -5,8 +5,25 @@
 
 #include <Arduino.h>
 #include "../utils/template_serializers.h"
+#include "../utils/serializers.h"
 #include <tuple>
 
+#define PRPC_KEY_SIGREQ 1
+#define PRPC_KEY_SIGRES 2
+#define PRPC_KEY_FUNCCALL 3
+#define PRPC_KEY_FUNCRETURN 4
+// dispatchers (see ./port_rpc_dispatch.h) also list their functions all at once, 
+#define PRPC_KEY_TABLEREQ 5
+#define PRPC_KEY_TABLERES 6
+// and many calls can ride in one packet, see rpcBatch() below 
+#define PRPC_KEY_BATCHCALL 7
+#define PRPC_KEY_BATCHRETURN 8
+// and results can be subscribed to, see runtime/subscriptions.h 
+#define PRPC_KEY_SUBSCRIBE 9
+#define PRPC_KEY_SUBRES 10
+#define PRPC_KEY_PUSH 11
+#define PRPC_KEY_UNSUBSCRIBE 12
+
 #define PRPC_FUNCNAME_MAX_CHAR 32
 #define PRPC_MAX_ARGS 8
 #define PRPC_ARGNAME_MAX_CHAR 16
@@ -23,66 +40,210 @@ struct ReturnType<void> {
     using Type = Unit;
 };
 
-// ------------------------------------ 
-// Storage for non-void return types
-template<typename Ret, bool isVoid>
-struct ResultStorage {
-    Ret result;
-};
-
-// Specialization for void return types that does not have a 'result' member
-template<typename Ret>
-struct ResultStorage<Ret, true> { };
-
-
-// ------------------------------------ 
-// one last trick for args storage ? 
-template<typename... Args>
-struct ArgStorage {
-  std::tuple<Args...> tuple;
-};
-
-// specialization for funcs with no args, 
-template<>
-struct ArgStorage<>{ };
-
-
 // ------------------------------------ recursive deserializer for Args... pack 
+// n.b. the braced-init, which (unlike a function call's args) is evaluated in order, left to right, 
+// and decayed types, so that const-ref args are decoded as values, 
+// check *rptr <= len after: any short read pushes it past the end 
 template<typename... Args, std::size_t... I>
-auto deserializeArgsImpl(uint8_t* data, size_t* rptr, std::index_sequence<I...>) {
-    return std::make_tuple(deserialize<Args>(data, rptr)...);
+auto deserializeArgsImpl(uint8_t* data, size_t* rptr, size_t len, std::index_sequence<I...>) {
+    return std::tuple<typename std::decay<Args>::type...>{ deserialize<Args>(data, rptr, len)... };
 }
 
 template<typename... Args>
-auto deserializeArgs(uint8_t* data, size_t* rptr) {
-    return deserializeArgsImpl<Args...>(data, rptr, std::index_sequence_for<Args...>{});
+auto deserializeArgs(uint8_t* data, size_t* rptr, size_t len) {
+    return deserializeArgsImpl<Args...>(data, rptr, len, std::index_sequence_for<Args...>{});
 }
 
+// ------------------------------------ calls 
+
+// decodes args from `args`, calls, and serializes the result into `ret`: 
+// returns false (w/o calling) if the args are malformed, and if the result doesn't fit 
+// in retMax, *retLen comes back larger than retMax, 
+template<typename Ret, typename... Args, typename Callable>
+boolean rpcInvoke(Callable func, uint8_t* args, size_t argsLen, uint8_t* ret, size_t retMax, size_t* retLen){
+  size_t rptr = 0;
+  size_t wptr = 0;
+  // we have four cases to deal with: void-void, void-args, ret-void, ret-args, 
+  if constexpr (sizeof...(Args) == 0){
+    if constexpr (std::is_same<Ret, void>::value){
+      func();
+    } else {
+      serialize<Ret>(func(), ret, &wptr, retMax);
+    }
+  } else {
+    // args are decoded onto the stack, many straight out of the packet (see RPCSpan) 
+    std::tuple<typename std::decay<Args>::type...> tuple = deserializeArgs<Args...>(args, &rptr, argsLen);
+    if(rptr > argsLen) return false;
+    if constexpr (std::is_same<Ret, void>::value){
+      std::apply(func, tuple);
+    } else {
+      serialize<Ret>(std::apply(func, tuple), ret, &wptr, retMax);
+    }
+  }
+  *retLen = wptr;
+  return true;
+}
 
-// copies from comma-delimited char[] into char[][], 
-void argSplitter(const char* input, char output[PRPC_MAX_ARGS][PRPC_ARGNAME_MAX_CHAR]){
-  int itemIndex = 0, charIndex = 0;
-  const char* p = input;
+// ------------------------------------ batches 
+
+// (replies go back along the route they came in on, so they're sized w/ its Route::maxPayload()) 
+// a result that ran past the end of the reply: the call happened, but we can't say what it returned, 
+// (real results are never this long, they'd have to fit in a packet) 
+#define PRPC_BATCH_RESULT_DROPPED 0xFFFF 
+
+// | PRPC_KEY_BATCHCALL | MSGID | N | ([INDEX] | ARGLEN | ARGS) * N | 
+// -> | PRPC_KEY_BATCHRETURN | MSGID | N_DONE | ([INDEX] | RETLEN:2 | RESULT) * N_DONE | 
+// w/ INDEX only on dispatchers, calls run in order, and the batch stops early 
+// (N_DONE < N) at a malformed call, a bad index, or once the reply is full, 
+// `call(index, args, argLen, ret, retMax, &retLen)` returns false to refuse one, 
+// callers have checked for | KEY | MSGID |, and a batch w/o N runs nothing, 
+// returns 0 (nothing to send) if even the reply's head won't fit in maxLen 
+template <typename CallFunc>
+size_t rpcBatch(uint8_t* data, size_t len, uint8_t* out, size_t maxLen, boolean indexed, CallFunc call){
+  if(maxLen < 3) return 0;
+  size_t wptr = 0;
+  out[wptr ++] = PRPC_KEY_BATCHRETURN;
+  out[wptr ++] = data[1];
+  size_t nPtr = wptr ++;
+  uint8_t done = 0;
+  uint8_t count = (len > 2) ? data[2] : 0;
+  size_t rptr = 3;
+  for(uint8_t c = 0; c < count; c ++){
+    // read the call's head, and check it's all here, 
+    uint8_t index = 0;
+    if(indexed){
+      if(rptr >= len) break;
+      index = data[rptr ++];
+    }
+    if(rptr >= len) break;
+    size_t argLen = data[rptr ++];
+    if(rptr + argLen > len) break;
+    // we need room to say (at least) that we ran it, 
+    size_t head = wptr;
+    if(wptr + (indexed ? 3 : 2) > maxLen) break;
+    if(indexed) out[wptr ++] = index;
+    size_t retLenPtr = wptr;
+    wptr += 2;
+    size_t retLen = 0;
+    if(!call(index, &(data[rptr]), argLen, &(out[wptr]), maxLen - wptr, &retLen)){
+      wptr = head;
+      break;
+    }
+    rptr += argLen;
+    done ++;
+    if(wptr + retLen > maxLen){
+      serializers_writeUint16(out, retLenPtr, PRPC_BATCH_RESULT_DROPPED);
+      break;
+    }
+    serializers_writeUint16(out, retLenPtr, retLen);
+    wptr += retLen;
+  }
+  out[nPtr] = done;
+  return wptr;
+}
 
-  while (*p && itemIndex < PRPC_MAX_ARGS) {
-    if (*p == ',' || *p == ' ') {
-      if (*p == ',' && charIndex > 0) { // End of an item
-        output[itemIndex][charIndex] = '\0'; // Null-terminate the current item
-        itemIndex++;
-        charIndex = 0;
-      }
-      p++; // Skip the comma or space
-    } else {
-      if (charIndex < PRPC_ARGNAME_MAX_CHAR - 1) { // Check for max char limit
-        output[itemIndex][charIndex++] = *p; // Copy character
-      }
-      p++; // Move to the next character
+// writes `count` names from a comma-delimited char[] as serialized strings, 
+// (empty ones if it has too few), and returns the length written, or only measures if dest is nullptr 
+constexpr size_t argNamesWrite(const char* input, uint8_t count, uint8_t* dest, size_t wptr){
+  size_t start = wptr;
+  const char* p = input;
+  for(uint8_t a = 0; a < count; a ++){
+    // skip delimiters, 
+    while(*p == ',' || *p == ' ') p ++;
+    // find the end of this one, 
+    const char* name = p;
+    while(*p && *p != ',' && *p != ' ') p ++;
+    size_t len = p - name;
+    if(len > PRPC_ARGNAME_MAX_CHAR - 1) len = PRPC_ARGNAME_MAX_CHAR - 1;
+    if(dest != nullptr){
+      dest[wptr] = TYPEKEY_STRING;
+      dest[wptr + 1] = len;
+      for(size_t c = 0; c < len; c ++) dest[wptr + 2 + c] = name[c];
     }
+    wptr += len + 2;
+  }
+  return wptr - start;
+}
+
+// ------------------------------------ signatures, at compile time 
+
+// the signature is | RET_TYPE | NUM_ARGS | ARG_TYPES... | <name> | <arg names>... |, 
+// and most of it is known at compile time: the types from the function's type, 
+template <typename Func>
+struct RPCTypes;
+
+template <typename Ret, typename... Args>
+struct RPCTypes<Ret(*)(Args...)> {
+  static_assert(sizeof...(Args) <= PRPC_MAX_ARGS, "rpc functions can have at most PRPC_MAX_ARGS args");
+  static constexpr uint8_t count = sizeof...(Args);
+  static constexpr uint8_t keys[sizeof...(Args) + 2] = { getTypeKey<Ret>(), sizeof...(Args), getTypeKey<Args>()... };
+};
+
+// async functions (see ./port_rpc.h) look to callers like they return what their completion carries, 
+template <typename Ret>
+class RPCDeferred;
+
+template <typename Ret, typename... Args>
+struct RPCTypes<void(*)(RPCDeferred<Ret>, Args...)> : RPCTypes<Ret(*)(Args...)> {};
+
+// and the names, if they're literals, so the whole reply can be built into flash, 
+template <size_t N>
+struct RPCSignature {
+  uint8_t bytes[N] = { };
+  size_t len = 0;
+};
+
+template <typename Func, size_t NameSize, size_t ArgNamesSize>
+constexpr auto rpcSignature(const char (&name)[NameSize], const char (&argNames)[ArgNamesSize]){
+  // the longest this could be, w/ each arg name getting a key and length, 
+  RPCSignature<sizeof(RPCTypes<Func>::keys) + NameSize + 1 + ArgNamesSize + 2 * RPCTypes<Func>::count> sig;
+  size_t wptr = 0;
+  for(size_t k = 0; k < sizeof(RPCTypes<Func>::keys); k ++){
+    sig.bytes[wptr ++] = RPCTypes<Func>::keys[k];
   }
+  size_t nameLen = NameSize - 1;
+  if(nameLen > PRPC_FUNCNAME_MAX_CHAR - 1) nameLen = PRPC_FUNCNAME_MAX_CHAR - 1;
+  sig.bytes[wptr ++] = TYPEKEY_STRING;
+  sig.bytes[wptr ++] = nameLen;
+  for(size_t c = 0; c < nameLen; c ++) sig.bytes[wptr ++] = name[c];
+  wptr += argNamesWrite(argNames, RPCTypes<Func>::count, sig.bytes, wptr);
+  sig.len = wptr;
+  return sig;
+}
+
+// or, from names only known at runtime, into dest, returns 0 if it would be longer than maxLen, 
+template <typename Func>
+size_t rpcSignatureWrite(const char* name, const char* argNames, uint8_t* dest, size_t maxLen){
+  size_t nameLen = strlen(name);
+  if(nameLen > PRPC_FUNCNAME_MAX_CHAR - 1) nameLen = PRPC_FUNCNAME_MAX_CHAR - 1;
+  size_t len = sizeof(RPCTypes<Func>::keys) + 2 + nameLen + argNamesWrite(argNames, RPCTypes<Func>::count, nullptr, 0);
+  if(len > maxLen) return 0;
+  size_t wptr = sizeof(RPCTypes<Func>::keys);
+  memcpy(dest, RPCTypes<Func>::keys, wptr);
+  dest[wptr ++] = TYPEKEY_STRING;
+  dest[wptr ++] = nameLen;
+  memcpy(&(dest[wptr]), name, nameLen);
+  wptr += nameLen;
+  wptr += argNamesWrite(argNames, RPCTypes<Func>::count, dest, wptr);
+  return wptr;
+}
 
-  if (charIndex > 0) { // Handle the last item if there's no trailing comma
-    output[itemIndex][charIndex] = '\0';
+// the | PRPC_KEY_SIGRES | MSGID | <signature> | reply, from flash if we have it, 
+// returns 0 if even the key and id won't fit, and leaves the signature out if it won't, (as rpcSignatureWrite() does)
+template <typename Func>
+size_t rpcSignatureReply(uint8_t msgID, const char* name, const char* argNames, const uint8_t* signature, size_t signatureLen, uint8_t* dest, size_t maxLen){
+  if(maxLen < 2) return 0;
+  size_t wptr = 0;
+  dest[wptr ++] = PRPC_KEY_SIGRES;
+  dest[wptr ++] = msgID;
+  if(signature != nullptr){
+    if(signatureLen > maxLen - wptr) return wptr;
+    memcpy(&(dest[wptr]), signature, signatureLen);
+    wptr += signatureLen;
+  } else {
+    wptr += rpcSignatureWrite<Func>(name, argNames, &(dest[wptr]), maxLen - wptr);
   }
+  return wptr;
 }
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,52 @@
+// trace dump-er 
+
+#include "port_trace.h"
+#include "../utils/serializers.h"
+
+#include "../utils/log.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_TRACE
+
+OSAP_Port_Trace::OSAP_Port_Trace(void) : VPort(OSAP_Runtime::getInstance()){
+  typeKey = PTYPEKEY_TRACE;
+}
+
+void OSAP_Port_Trace::onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort){
+  switch(data[0]){
+    case PTRACE_DUMP_REQ:
+      {
+        // | PTRACE_DUMP_REQ | ID | FROM:4 |, short ones are dropped, 
+        if(len < 6) break;
+        uint32_t from = serializers_readUint32(data, 2);
+        uint32_t head = traceGetHead();
+        // oldest still-in-ring, 
+        uint32_t oldest = head > OSAP_CONFIG_TRACE_LENGTH ? head - OSAP_CONFIG_TRACE_LENGTH : 0;
+        if(from < oldest) from = oldest;
+        // header, 
+        uint16_t wptr = 0;
+        _payload[wptr ++] = PTRACE_DUMP_RES;
+        _payload[wptr ++] = data[1];
+        _payload[wptr ++] = traceGetTimebase();
+        serializers_writeUint32(_payload, &wptr, head);
+        serializers_writeUint32(_payload, &wptr, from);
+        uint16_t countPtr = wptr ++;
+        // this msg is going to grow the trace by a few events as well, but 
+        // we snapshot the head above so those land in the next page 
+        uint16_t maxLen = sourceRoute->maxPayload();
+        uint8_t count = 0;
+        while(wptr + 8 <= maxLen && from + count < head && count < 255){
+          if(!traceRead(from + count, &(_payload[wptr]))) break;
+          wptr += 8;
+          count ++;
+        }
+        _payload[countPtr] = count;
+        send(_payload, wptr, sourceRoute, sourcePort);
+      }
+      break;
+    default:
+      OSAP_LOG(LOGCODE_PORT_BAD_KEY, (typeKey << 8) | data[0]);
+      break;
+  }
+}
+
+#endif 
@@ -0,0 +1,27 @@
+// dumps the trace ring to whoever asks 
+
+#ifndef PORT_TRACE_H_
+#define PORT_TRACE_H_
+
+#include "../structure/ports.h"
+#include "../utils/trace.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_TRACE
+
+// | PTRACE_DUMP_REQ | ID | FROM:4 | 
+// | PTRACE_DUMP_RES | ID | TIMEBASE | HEAD:4 | FIRST:4 | COUNT | EVENT:8 * COUNT | 
+// where FROM, HEAD and FIRST are absolute event indices: the host pages 
+// thru by re-requesting from FIRST + COUNT until it catches HEAD, 
+// if FROM has been overwritten we start at the oldest event still in the ring 
+#define PTRACE_DUMP_REQ 1 
+#define PTRACE_DUMP_RES 2 
+
+class OSAP_Port_Trace : public VPort {
+  public:
+    OSAP_Port_Trace(void);
+    void onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) override;
+};
+
+#endif 
+
+#endif 
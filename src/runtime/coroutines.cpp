@@ -0,0 +1,122 @@
+/*
+osap/coroutines.cpp
+
+tasks that co_await the runtime, w/o hand-rolled state machines
+
+Jake Read at the Center for Bits and Atoms
+(c) Massachusetts Institute of Technology 2022
+
+This work may be reproduced, modified, distributed, performed, and
+displayed for any purpose, but must acknowledge the osap project.
+Copyright is retained and must be preserved. The work is provided as is;
+no warranty is provided, and users accept all liability.
+*/
+
+#include "coroutines.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_COROUTINES
+
+#include "../structure/ports.h"
+
+// ---------------------------------------------- Frame Pool
+
+struct OSAP_CoFrame {
+  alignas(max_align_t) uint8_t bytes[OSAP_CONFIG_COROUTINE_FRAME_SIZE];
+};
+
+OSAP_CoFrame coroutineFrames[OSAP_CONFIG_COROUTINE_SLOTS];
+boolean coroutineFramesUsed[OSAP_CONFIG_COROUTINE_SLOTS];
+
+void* OSAP_Task::promise_type::operator new(size_t size) noexcept {
+  if(size > OSAP_CONFIG_COROUTINE_FRAME_SIZE) return nullptr;
+  for(uint8_t f = 0; f < OSAP_CONFIG_COROUTINE_SLOTS; f ++){
+    if(coroutineFramesUsed[f]) continue;
+    coroutineFramesUsed[f] = true;
+    return coroutineFrames[f].bytes;
+  }
+  return nullptr;
+}
+
+void OSAP_Task::promise_type::operator delete(void* ptr, size_t size){
+  size_t f = (OSAP_CoFrame*)ptr - coroutineFrames;
+  if(f < OSAP_CONFIG_COROUTINE_SLOTS) coroutineFramesUsed[f] = false;
+}
+
+// ---------------------------------------------- Waits
+
+OSAP_CoWait* coroutineWaits = nullptr;
+
+void coroutinesWait(OSAP_CoWait* wait){
+  wait->since = millis();
+  wait->next = coroutineWaits;
+  coroutineWaits = wait;
+}
+
+OSAP_CoWait* coroutinesFindRequest(VPort* vport, uint8_t msgID, Route* sourceRoute, uint16_t sourcePort){
+  for(OSAP_CoWait* wait = coroutineWaits; wait != nullptr; wait = wait->next){
+    if(wait->kind != COWAIT_REQUEST_REPLY || wait->replied) continue;
+    if(wait->vport != vport || wait->msgID != msgID || wait->destinationPort != sourcePort) continue;
+    // port indices are only unique per runtime, so the reply has to come back along our route, 
+    if(wait->route->encodedPathLen != sourceRoute->encodedPathLen) continue;
+    if(memcmp(wait->route->encodedPath, sourceRoute->encodedPath, sourceRoute->encodedPathLen) != 0) continue;
+    return wait;
+  }
+  return nullptr;
+}
+
+// true once the wait is over,
+static boolean coroutinesCheck(OSAP_CoWait* wait, uint32_t now){
+  switch(wait->kind){
+    case COWAIT_SLEEP:
+      return now - wait->since >= wait->timeout;
+    case COWAIT_SEND:
+      return wait->vport->clearToSend();
+    case COWAIT_REQUEST_SEND:
+      // requests go out as soon as they can, and then wait on the reply,
+      // the timeout runs from the co_await, so it covers waiting for space as well,
+      if(now - wait->since > wait->timeout) return true;
+      if(wait->vport->clearToSend()){
+        wait->data[1] = wait->msgID;
+        wait->vport->send(wait->data, wait->len, wait->route, wait->destinationPort);
+        wait->kind = COWAIT_REQUEST_REPLY;
+      }
+      return false;
+    case COWAIT_REQUEST_REPLY:
+      return wait->replied || (now - wait->since > wait->timeout);
+    default:
+      return true;
+  }
+}
+
+void coroutinesLoop(void){
+  if(coroutineWaits == nullptr) return;
+  uint32_t now = millis();
+  // resumed tasks can list new waits as we go, so we only visit those listed as of now,
+  // (a task waits on one thing at a time, so there are at most this many)
+  OSAP_CoWait* waits[OSAP_CONFIG_COROUTINE_SLOTS];
+  uint8_t count = 0;
+  for(OSAP_CoWait* wait = coroutineWaits; wait != nullptr && count < OSAP_CONFIG_COROUTINE_SLOTS; wait = wait->next){
+    waits[count ++] = wait;
+  }
+  for(uint8_t w = 0; w < count; w ++){
+    // checked one at a time, since i.e. the first of two sends can take the last stack space,
+    if(!coroutinesCheck(waits[w], now)) continue;
+    // unlist it,
+    OSAP_CoWait** link = &coroutineWaits;
+    while(*link != waits[w]) link = &((*link)->next);
+    *link = waits[w]->next;
+    // and carry on,
+    waits[w]->handle.resume();
+  }
+}
+
+// ---------------------------------------------- Awaitables
+
+OSAP_SleepAwaiter osapSleep(uint32_t ms){
+  OSAP_SleepAwaiter awaiter;
+  awaiter.wait.kind = COWAIT_SLEEP;
+  awaiter.wait.timeout = ms;
+  return awaiter;
+}
+
+#endif
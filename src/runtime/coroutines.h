@@ -0,0 +1,116 @@
+/*
+osap/coroutines.h
+
+tasks that co_await the runtime, w/o hand-rolled state machines
+
+Jake Read at the Center for Bits and Atoms
+(c) Massachusetts Institute of Technology 2022
+
+This work may be reproduced, modified, distributed, performed, and
+displayed for any purpose, but must acknowledge the osap project.
+Copyright is retained and must be preserved. The work is provided as is;
+no warranty is provided, and users accept all liability.
+*/
+
+#ifndef OSAP_COROUTINES_H_
+#define OSAP_COROUTINES_H_
+
+#include <Arduino.h>
+#include "../osap_config.h"
+#include "../packets/routes.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_COROUTINES
+
+#include <coroutine>
+
+class VPort;
+
+// ---------------------------------------------- Tasks
+
+// any function returning an OSAP_Task can co_await, i.e.
+//
+// OSAP_Task pollTemp(void){
+//   while(true){
+//     size_t len = co_await sensorPort.request(req, 2, &route, 1, reply, sizeof(reply));
+//     ...
+//     co_await osapSleep(100);
+//   }
+// }
+//
+// it runs (in the caller) until its first co_await, and from then on it's resumed by
+// the runtime's loop, its frame comes from a fixed pool: a task that doesn't fit
+// (or finds the pool full) doesn't start, see .started()
+class OSAP_Task {
+  public:
+    struct promise_type {
+      OSAP_Task get_return_object(void){ return OSAP_Task(true); }
+      static OSAP_Task get_return_object_on_allocation_failure(void){ return OSAP_Task(false); }
+      std::suspend_never initial_suspend(void) noexcept { return {}; }
+      // frames are freed as soon as tasks return,
+      std::suspend_never final_suspend(void) noexcept { return {}; }
+      void return_void(void){}
+      void unhandled_exception(void){}
+      // from the pool, never the heap,
+      static void* operator new(size_t size) noexcept;
+      static void operator delete(void* ptr, size_t size);
+    };
+    boolean started(void){ return _started; }
+
+  private:
+    OSAP_Task(boolean started) : _started(started) {}
+    boolean _started;
+};
+
+// ---------------------------------------------- Waits
+
+#define COWAIT_SLEEP 1
+#define COWAIT_SEND 2
+#define COWAIT_REQUEST_SEND 3
+#define COWAIT_REQUEST_REPLY 4
+
+// a suspended task, and what it's waiting on: these live in the task's frame
+// (as part of the awaiter), and are listed here until the runtime resumes them,
+typedef struct OSAP_CoWait {
+  std::coroutine_handle<> handle;
+  uint8_t kind = 0;
+  VPort* vport = nullptr;
+  uint32_t since = 0;
+  uint32_t timeout = 0;
+  // requests go out (w/ our msg id stamped into data[1]) as soon as there's space,
+  uint8_t* data = nullptr;
+  size_t len = 0;
+  Route* route = nullptr;
+  uint16_t destinationPort = 0;
+  uint8_t msgID = 0;
+  // and then wait on a reply to it, from that port, into this buffer,
+  uint8_t* reply = nullptr;
+  size_t replySize = 0;
+  size_t replyLen = 0;
+  boolean replied = false;
+  OSAP_CoWait* next = nullptr;
+} OSAP_CoWait;
+
+// lists a wait,
+void coroutinesWait(OSAP_CoWait* wait);
+// the request waiting on this reply, if any: the same msg id, from the port and path it went to,
+OSAP_CoWait* coroutinesFindRequest(VPort* vport, uint8_t msgID, Route* sourceRoute, uint16_t sourcePort);
+// resumes those that are done waiting, once per runtime loop
+void coroutinesLoop(void);
+
+// ---------------------------------------------- Awaitables
+
+// co_await osapSleep(ms)
+struct OSAP_SleepAwaiter {
+  OSAP_CoWait wait;
+  boolean await_ready(void){ return wait.timeout == 0; }
+  void await_suspend(std::coroutine_handle<> handle){
+    wait.handle = handle;
+    coroutinesWait(&wait);
+  }
+  void await_resume(void){}
+};
+
+OSAP_SleepAwaiter osapSleep(uint32_t ms);
+
+#endif
+#endif
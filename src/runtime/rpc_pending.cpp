@@ -0,0 +1,63 @@
+/*
+osap/rpc_pending.cpp
+
+rpc calls that complete after their handler returns
+
+Jake Read at the Center for Bits and Atoms
+(c) Massachusetts Institute of Technology 2022
+
+This work may be reproduced, modified, distributed, performed, and
+displayed for any purpose, but must acknowledge the osap project.
+Copyright is retained and must be preserved. The work is provided as is;
+no warranty is provided, and users accept all liability.
+*/
+
+#include "rpc_pending.h"
+#include "../utils/log.h"
+
+static_assert(OSAP_CONFIG_RPC_PENDING_SLOTS < RPC_PENDING_NONE, "OSAP_CONFIG_RPC_PENDING_SLOTS must be fewer than 255");
+
+RPCPending rpcPendingSlots[OSAP_CONFIG_RPC_PENDING_SLOTS];
+
+uint8_t rpcPendingOpen(VPort* vport, Route* route, uint16_t destinationPort, uint8_t msgID, uint32_t timeout, uint8_t* generation){
+  for(uint8_t s = 0; s < OSAP_CONFIG_RPC_PENDING_SLOTS; s ++){
+    RPCPending* pending = &(rpcPendingSlots[s]);
+    if(pending->vport != nullptr) continue;
+    pending->vport = vport;
+    pending->route = *route;
+    pending->destinationPort = destinationPort;
+    pending->msgID = msgID;
+    pending->generation ++;
+    pending->openedAt = millis();
+    pending->timeout = timeout;
+    *generation = pending->generation;
+    return s;
+  }
+  OSAP_LOG(LOGCODE_RPC_PENDING_FULL, msgID);
+  return RPC_PENDING_NONE;
+}
+
+RPCPending* rpcPendingGet(uint8_t slot, uint8_t generation){
+  if(slot >= OSAP_CONFIG_RPC_PENDING_SLOTS) return nullptr;
+  RPCPending* pending = &(rpcPendingSlots[slot]);
+  if(pending->vport == nullptr || pending->generation != generation) return nullptr;
+  return pending;
+}
+
+void rpcPendingClose(uint8_t slot){
+  if(slot >= OSAP_CONFIG_RPC_PENDING_SLOTS) return;
+  rpcPendingSlots[slot].vport = nullptr;
+}
+
+void rpcPendingLoop(void){
+  uint32_t now = millis();
+  for(uint8_t s = 0; s < OSAP_CONFIG_RPC_PENDING_SLOTS; s ++){
+    RPCPending* pending = &(rpcPendingSlots[s]);
+    if(pending->vport == nullptr) continue;
+    // the caller has likely given up by now, and late completions are refused,
+    if(now - pending->openedAt > pending->timeout){
+      OSAP_LOG(LOGCODE_RPC_PENDING_TIMEOUT, pending->msgID);
+      pending->vport = nullptr;
+    }
+  }
+}
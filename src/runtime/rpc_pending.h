@@ -0,0 +1,49 @@
+/*
+osap/rpc_pending.h
+
+rpc calls that complete after their handler returns
+
+Jake Read at the Center for Bits and Atoms
+(c) Massachusetts Institute of Technology 2022
+
+This work may be reproduced, modified, distributed, performed, and
+displayed for any purpose, but must acknowledge the osap project.
+Copyright is retained and must be preserved. The work is provided as is;
+no warranty is provided, and users accept all liability.
+*/
+
+#ifndef OSAP_RPC_PENDING_H_
+#define OSAP_RPC_PENDING_H_
+
+#include <Arduino.h>
+#include "../packets/routes.h"
+
+class VPort;
+
+// an async rpc (see port_integrations/port_rpc.h) holds one of these between the call
+// and its completion: everything we need to reply, w/o holding a packet on the stack,
+typedef struct RPCPending {
+  VPort* vport = nullptr;
+  // the (reversed) route the call came in on, and the caller's port,
+  Route route;
+  uint16_t destinationPort = 0;
+  uint8_t msgID = 0;
+  // completions check this against their own, so that a stale one can't
+  // answer for whichever call has the slot now,
+  uint8_t generation = 0;
+  uint32_t openedAt = 0;
+  uint32_t timeout = 0;
+} RPCPending;
+
+#define RPC_PENDING_NONE 255
+
+// claims a slot for a call, returning its index (and generation), or RPC_PENDING_NONE if all are in use,
+uint8_t rpcPendingOpen(VPort* vport, Route* route, uint16_t destinationPort, uint8_t msgID, uint32_t timeout, uint8_t* generation);
+// the slot, if it's still the call w/ that generation, otherwise nullptr,
+RPCPending* rpcPendingGet(uint8_t slot, uint8_t generation);
+// frees it,
+void rpcPendingClose(uint8_t slot);
+// the runtime drops those that have timed out, once per loop
+void rpcPendingLoop(void);
+
+#endif
@@ -6,6 +6,14 @@
 
 #include "../osap_config.h"
 #include "../utils/debug.h"
+#include "../utils/trace.h"
+#include "../utils/log.h"
+#include "traversal.h"
+#include "../packets/route_ids.h"
+#include "../packets/fragments.h"
+#include "rpc_pending.h"
+#include "coroutines.h"
+#include "subscriptions.h"
 
 // ---------------------------------------------- Singleton
 
@@ -26,12 +34,16 @@ uint8_t OSAP_Runtime::_payload[OSAP_CONFIG_PACKET_MAX_SIZE];
 // ---------------------------------------------- Message Stack and Constructor
 
 // stack size modifies how much memory the device sucks, 
-// it should be configured per-micro-platform (?) or sth, 
-// we need some arduino help... other options are to expose 
-// memory allocation to the user, but it's a little awkward 
+// it's set per-part in osap_config.h, and can be overridden there (see Overrides) 
 
 VPacket _stack[OSAP_CONFIG_STACK_SIZE];
 
+// overrides can get these wrong, so: 
+static_assert(OSAP_CONFIG_STACK_SIZE >= 2, "OSAP_CONFIG_STACK_SIZE must be at least 2");
+static_assert(OSAP_CONFIG_MAX_LGATEWAYS <= 32, "OSAP_CONFIG_MAX_LGATEWAYS must be 32 or fewer (see lgatewayOpenBits)");
+static_assert(OSAP_CONFIG_MAX_PORTS <= 65535, "OSAP_CONFIG_MAX_PORTS must fit in a uint16_t");
+static_assert(OSAP_CONFIG_ROUTE_MAX_LENGTH + 5 < OSAP_CONFIG_PACKET_MAX_SIZE, "OSAP_CONFIG_PACKET_MAX_SIZE must fit a header and a full route");
+
 OSAP_Runtime::OSAP_Runtime(void){
   // collect stack from the file scope,
   stack = _stack;
@@ -46,14 +58,82 @@ OSAP_Runtime::OSAP_Runtime(void){
 void OSAP_Runtime::begin(void){
   // TODO: startup link-list, 
   stackReset(stack, stackSize);
+  #ifdef OSAP_CONFIG_INCLUDE_TRACE
+  traceBegin();
+  #endif 
   // for each link in list, do link->begin();
   for(uint16_t l = 0; l < lgatewayCount; l ++){
     lgateways[l]->begin();
   }
+  #ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+  // ibid for busses, 
+  for(uint16_t b = 0; b < bgatewayCount; b ++){
+    bgateways[b]->begin();
+  }
+  #endif 
   // for each port, do port->begin();
   for(uint16_t p = 0; p < portCount; p ++){
     ports[p]->begin();
   }
+  // now that names are loaded (i.e. from flash), sign the structure, 
+  // registrations have already bumped the epoch, and we leave it be 
+  uint32_t sig = 5381;
+  for(uint16_t p = 0; p < portCount; p ++){
+    sig = sig * 33 + ports[p]->typeKey;
+    const char* name;
+    for(uint8_t n = 0; (name = ports[p]->getName(n)) != nullptr; n ++){
+      while(*name) sig = sig * 33 + *(name ++);
+    }
+  }
+  for(uint16_t l = 0; l < lgatewayCount; l ++){
+    sig = sig * 33 + lgateways[l]->typeKey;
+  }
+  signature = sig;
+}
+
+// ---------------------------------------------- Topology Epoch 
+
+void OSAP_Runtime::seedEpoch(uint32_t bootCount){
+  // keeping what's been counted so far (i.e. registrations), 
+  epoch += bootCount << 16;
+}
+
+void OSAP_Runtime::bumpEpoch(void){
+  epoch ++;
+}
+
+uint32_t OSAP_Runtime::getEpoch(void){
+  return epoch;
+}
+
+uint32_t OSAP_Runtime::getSignature(void){
+  return signature;
+}
+
+// ---------------------------------------------- Stats Utes 
+
+// tkeys are sparse, we count 'em in slots, 
+static uint8_t statsKeySlot(uint8_t key){
+  switch(key){
+    case TKEY_LINKF: 
+    case TKEY_LINKF_S: return OSAP_STATS_SLOT_LINKF;
+    case TKEY_BUSF: return OSAP_STATS_SLOT_BUSF;
+    case TKEY_BUSB: return OSAP_STATS_SLOT_BUSB;
+    case TKEY_PORTPACK: 
+    case TKEY_PORTPACK_S: 
+    case TKEY_PORTFRAG: return OSAP_STATS_SLOT_PORTPACK;
+    case TKEY_RUNTIMEINFO_REQ: return OSAP_STATS_SLOT_RUNTIMEINFO;
+    case TKEY_PORTINFO_REQ: return OSAP_STATS_SLOT_PORTINFO;
+    case TKEY_LGATEWAYINFO_REQ: return OSAP_STATS_SLOT_LGATEWAYINFO;
+    case TKEY_BGATEWAYINFO_REQ: return OSAP_STATS_SLOT_BGATEWAYINFO;
+    case TKEY_STATS_REQ: return OSAP_STATS_SLOT_STATS;
+    case TKEY_LOG_REQ: return OSAP_STATS_SLOT_LOG;
+    case TKEY_DISCOVER_REQ: return OSAP_STATS_SLOT_DISCOVER;
+    case TKEY_RIDF: 
+    case TKEY_LINKF_RI: 
+    case TKEY_PORTPACK_RI: return OSAP_STATS_SLOT_RIDF;
+    default: return OSAP_STATS_SLOT_OTHER;
+  }
 }
 
 // ---------------------------------------------- Core Runtime Loop 
@@ -65,12 +145,43 @@ VPacket* packets[OSAP_CONFIG_STACK_SIZE];
 void OSAP_Runtime::loop(void){
   // (0) check the time, 
   uint32_t now = millis();
+  OSAP_TRACE(TRACE_EVT_LOOP_ENTER, 0, 0);
 
   // (1) run each links' loop code:
   for(uint16_t l = 0; l < lgatewayCount; l ++){
-    if(lgateways[l] != nullptr) lgateways[l]->loop();
+    if(lgateways[l] == nullptr) continue;
+    lgateways[l]->loop();
+    // link open / close changes the graph, 
+    uint32_t bit = (uint32_t)1 << l;
+    if(lgateways[l]->isOpen() != ((lgatewayOpenBits & bit) != 0)){
+      lgatewayOpenBits ^= bit;
+      bumpEpoch();
+    }
+  }
+  #ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+  for(uint16_t b = 0; b < bgatewayCount; b ++){
+    if(bgateways[b] != nullptr) bgateways[b]->loop();
+  }
+  #endif 
+
+  // and each port's, 
+  for(uint16_t p = 0; p < portCount; p ++){
+    ports[p]->loop();
   }
 
+  // (1.5) the scanner, if we have one, issues requests, 
+  if(traversal != nullptr) traversal->loop();
+  // and large messages go out in pieces, 
+  fragmentsLoop();
+  // and async rpc calls that never completed are let go, 
+  rpcPendingLoop();
+  // subscriptions push their samples, 
+  subscriptionsLoop();
+  #ifdef OSAP_CONFIG_INCLUDE_COROUTINES
+  // and tasks waiting on the above are resumed, 
+  coroutinesLoop();
+  #endif 
+
   // (2) collect paquiats from the staquiat,
   size_t count = stackGetPacketsToService(packets, OSAP_CONFIG_STACK_SIZE);
 
@@ -82,7 +193,9 @@ void OSAP_Runtime::loop(void){
 
     // (3:1) time out deadies, 
     if(packets[p]->serviceDeadline < now){
-      OSAP_DEBUG("packet t/o");
+      OSAP_LOG(LOGCODE_PACKET_TIMEOUT, packets[p]->data[packets[p]->data[0]]);
+      OSAP_TRACE(TRACE_EVT_TIMEOUT, packets[p]->data[packets[p]->data[0]], 0);
+      stats.timeouts ++;
       relinquishPacketToStack(packets[p]);
       continue;
     }
@@ -91,64 +204,150 @@ void OSAP_Runtime::loop(void){
     // ... pck[0] is a pointer to the active instruction, 
     // so pck[pck[0]] == OPCODE, basically 
     VPacket* pck = packets[p];
+    // we count it once it's gone on (forwarded, delivered, replied-to or dropped), 
+    // not while it waits on a busy link, 
+    uint8_t slot = statsKeySlot(pck->data[pck->data[0]]);
+    boolean awaiting = false;
+    OSAP_TRACE(TRACE_EVT_SERVICE, pck->data[pck->data[0]], p);
     switch(pck->data[pck->data[0]]){
       // -------------------- Packets destined for a port in this runtime:
+      // | TKEY_PORTPACK | src:2 | dst:2 | or | TKEY_PORTPACK_S | src | dst | 
       case TKEY_PORTPACK: 
+      case TKEY_PORTPACK_S: 
         {
           // deliver the packet to this port, from that one... 
-          uint16_t sourceIndex = serializers_readUint16(pck->data, pck->data[0] + 1);
-          uint16_t destinationIndex = serializers_readUint16(pck->data, pck->data[0] + 3);
+          uint16_t sourceIndex, destinationIndex, payloadStart;
+          if(pck->data[pck->data[0]] == TKEY_PORTPACK){
+            sourceIndex = serializers_readUint16(pck->data, pck->data[0] + 1);
+            destinationIndex = serializers_readUint16(pck->data, pck->data[0] + 3);
+            payloadStart = pck->data[0] + 5;
+          } else {
+            sourceIndex = pck->data[pck->data[0] + 1];
+            destinationIndex = pck->data[pck->data[0] + 2];
+            payloadStart = pck->data[0] + TKEY_PORTPACK_S_INC;
+          }
           // if we've got one, 
           if(destinationIndex < portCount){
             // copy the route out into our temp-stash, 
             getRouteFromPacket(pck, &_route);
             // reverse that, 
             _route.reverse();
-            // copy the datagram out, since packet might be re-allocated
-            // during the func call: 
-            size_t payloadLen = pck->len - (pck->data[0] + 5);
-            memcpy(_payload, &(pck->data[pck->data[0] + 5]), payloadLen);
-            // now we can dooo
-            // (1) de-allocate the packet, means we have guaranteed-clear space 
-            // if the func call below wants to re-allocate: 
-            relinquishPacketToStack(pck);
-            // (2) call the func
-            ports[destinationIndex]->onPacket(_payload, payloadLen, &_route, sourceIndex);
+            // and hand it over, 
+            deliver(pck, payloadStart, sourceIndex, destinationIndex);
           } else {
-            OSAP_ERROR("msg to non-existent port " + String(destinationIndex));
+            OSAP_LOG(LOGCODE_PORTPACK_BAD_PORT, destinationIndex);
+            stats.badPortDrops ++;
             relinquishPacketToStack(pck);
           }
         }
         break;
+      // -------------------- Pieces of large messages, for a port in this runtime: 
+      case TKEY_PORTFRAG:
+        {
+          uint16_t ptr = pck->data[0];
+          uint16_t sourceIndex = serializers_readUint16(pck->data, ptr + 1);
+          uint16_t destinationIndex = serializers_readUint16(pck->data, ptr + 3);
+          if(destinationIndex >= portCount || ports[destinationIndex] == nullptr){
+            OSAP_LOG(LOGCODE_PORTPACK_BAD_PORT, destinationIndex);
+            stats.badPortDrops ++;
+            relinquishPacketToStack(pck);
+            break;
+          }
+          // copy in, and free the packet before we call up, 
+          FragmentRx* whole = fragmentsIngest(ports[destinationIndex], pck);
+          if(whole != nullptr){
+            getRouteFromPacket(pck, &_route);
+            _route.reverse();
+          }
+          relinquishPacketToStack(pck);
+          if(whole != nullptr){
+            OSAP_TRACE(TRACE_EVT_ONPACKET_ENTER, 0, destinationIndex);
+            ports[destinationIndex]->onPacket(whole->buffer, whole->total, &_route, sourceIndex);
+            OSAP_TRACE(TRACE_EVT_ONPACKET_EXIT, 0, destinationIndex);
+          }
+        }
+        break;
       // -------------------- Packets for us to forward along one of our links:
+      // | TKEY_LINKF | index:2 | or | TKEY_LINKF_S | index | 
       case TKEY_LINKF:
+      case TKEY_LINKF_S:
         {
           // collect the index 
-          uint16_t index = serializers_readUint16(pck->data, pck->data[0] + 1);
+          uint16_t index = (pck->data[pck->data[0]] == TKEY_LINKF) ? 
+            serializers_readUint16(pck->data, pck->data[0] + 1) : pck->data[pck->data[0] + 1];
           // pass checks 
-          if(index > lgatewayCount){
-            OSAP_ERROR("linkf along non-existent link " + String(index));
+          if(index >= lgatewayCount){
+            OSAP_LOG(LOGCODE_LINKF_BAD_LINK, index);
+            stats.badLinkDrops ++;
             relinquishPacketToStack(pck);
             break;
           } else if (lgateways[index] == nullptr){
-            OSAP_ERROR("linkf along non-existent link" + String(index));
+            OSAP_LOG(LOGCODE_LINKF_BAD_LINK, index);
+            stats.badLinkDrops ++;
             relinquishPacketToStack(pck);
             break;
+          } else if(!fitToLink(pck, lgateways[index])){
+            break;
           } else {
             // send if clear, wait if not 
             if(lgateways[index]->clearToSend()){
+              OSAP_TRACE(TRACE_EVT_SEND, pck->data[pck->data[0]], index);
               lgateways[index]->send(pck->data, pck->len);
+              lgateways[index]->bytesOut += pck->len;
               relinquishPacketToStack(pck);
             } else {
               // awaiting (!) 
+              awaiting = true;
             }
           }
         }
         break;
       // -------------------- Packets for us to forward along one of our busses:
+      // | TKEY_BUSF | index:2 | address:2 | to one drop, 
+      // | TKEY_BUSB | index:2 | channel:2 | to every drop subscribed to the channel 
       case TKEY_BUSF:
-        OSAP_ERROR("not-yet servicing busses...");
+      case TKEY_BUSB:
+        {
+          #ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+          uint8_t key = pck->data[pck->data[0]];
+          uint16_t index = serializers_readUint16(pck->data, pck->data[0] + 1);
+          uint16_t target = serializers_readUint16(pck->data, pck->data[0] + 3);
+          if(index >= bgatewayCount || bgateways[index] == nullptr){
+            OSAP_LOG(LOGCODE_BUSF_BAD_BUS, index);
+            stats.badBusDrops ++;
+            relinquishPacketToStack(pck);
+            break;
+          }
+          // send if clear, wait if not, 
+          if(key == TKEY_BUSF && bgateways[index]->clearToSend(target)){
+            OSAP_TRACE(TRACE_EVT_SEND, TKEY_BUSF, index);
+            bgateways[index]->send(target, pck->data, pck->len);
+          } else if (key == TKEY_BUSB && bgateways[index]->clearToBroadcast(target)){
+            OSAP_TRACE(TRACE_EVT_SEND, TKEY_BUSB, index);
+            bgateways[index]->broadcast(target, pck->data, pck->len);
+          } else {
+            // awaiting (!) 
+            awaiting = true;
+            break;
+          }
+          bgateways[index]->bytesOut += pck->len;
+          relinquishPacketToStack(pck);
+          #else 
+          OSAP_LOG(LOGCODE_BUSSES_NOT_INCLUDED, 0);
+          relinquishPacketToStack(pck);
+          #endif 
+        }
+        break;
+      // -------------------- Interned routes: labels, and their installs 
+      case TKEY_RIDF:
+      case TKEY_LINKF_RI:
+      case TKEY_PORTPACK_RI:
+        #ifdef OSAP_CONFIG_INCLUDE_ROUTE_IDS
+        awaiting = !serviceRouteID(pck);
+        #else 
+        OSAP_LOG(LOGCODE_ROUTEIDS_NOT_INCLUDED, pck->data[pck->data[0]]);
         relinquishPacketToStack(pck);
+        #endif 
         break;
       // -------------------- Graph traversal high-level query:
       case TKEY_RUNTIMEINFO_REQ:
@@ -158,35 +357,10 @@ void OSAP_Runtime::loop(void){
           // it's the scope response, w/ matched ID 
           _payload[0] = TKEY_RUNTIMEINFO_RES;
           _payload[1] = pck->data[pck->data[0] + 1];
-          // traverseID handoff:
-          // copy-old into packet, 
-          memcpy(&(_payload[2]), previousTraverseID, 4);
-          // copy-new into stash: 
-          memcpy(previousTraverseID, &(pck->data[pck->data[0] + 2]), 4);
-          // report build-type, 
-          _payload[6] = BTYPEKEY_EMBEDDED_CPP;
-          // osap-version, 
-          _payload[7] = OSAP_VERSION_MAJOR;
-          _payload[8] = OSAP_VERSION_MID;
-          _payload[9] = OSAP_VERSION_MINOR;
-          // we stuff the first-exit instruction in here 
-          // since the scanner will be reconstructing the graph, 
-          // they need to know how tf this mf' entered this rt, so we do:
-          getRouteFromPacket(pck, &_route);
-          // we can copy-pasta 5 of these bytos:
-          memcpy(&(_payload[10]), _route.encodedPath, 5);
-          // it *might* be from-ourselves, though probably not for some time
-          // this is the only case where we should be sure about the 1st byte
-          // not coming from random memory:
-          if(_route.encodedPathLen == 0){
-            _payload[10] = 0;
-          }
-          // ports-count, links-count, busses-count, 
-          serializers_writeUint16(_payload, 15, portCount);
-          serializers_writeUint16(_payload, 17, lgatewayCount);
-          serializers_writeUint16(_payload, 19, bgatewayCount);
+          // the body is shared w/ discovery, traverseID is in the req at [2:6]
+          size_t len = writeRuntimeInfo(pck, &(pck->data[pck->data[0] + 2]), &(_payload[2]));
           // and reply w/ this ute, 
-          reply(pck, _payload, 20);
+          reply(pck, _payload, len + 2);
         }
         break;
       // -------------------- Gets high-level info on groups of ports... 
@@ -239,15 +413,17 @@ void OSAP_Runtime::loop(void){
           // inclusive of start, exclusive of end: 
           for(uint8_t i = startIndex; i < endIndex; i ++){
             // check-each, 
-            if(wptr > maxReplyLength) break;
-            if(i > lgatewayCount) break;
-            // and fill, reporting type-key and open-ness, 
+            if(wptr + 4 > maxReplyLength) break;
+            if(i >= lgatewayCount) break;
+            // and fill, reporting type-key, open-ness, and MTU, 
             if(lgateways[i] == nullptr){
               _payload[wptr ++] = LGATEWAYTYPEKEY_NULL;
               _payload[wptr ++] = 0;
+              serializers_writeUint16(_payload, &wptr, 0);
             } else {
               _payload[wptr ++] = lgateways[i]->typeKey;
               _payload[wptr ++] = lgateways[i]->isOpen() ? 1 : 0;
+              serializers_writeUint16(_payload, &wptr, lgateways[i]->getMTU());
             }
           } // end stuff-routine
           // reply 2 sender 
@@ -256,26 +432,550 @@ void OSAP_Runtime::loop(void){
         break;
       // -------------------- Get high-level info on groups of busses... 
       case TKEY_BGATEWAYINFO_REQ:
-        // TODO: busses should stuff the type of bus & then the 32-byte (256-bit)
-        // open (1) / closed (0) state... 
-        OSAP_ERROR("not-yet servicing busses...");
+        {
+          // as w/ links, for a spread of busses:
+          uint8_t startIndex = pck->data[pck->data[0] + 2];
+          uint8_t endIndex = pck->data[pck->data[0] + 3];
+          uint16_t wptr = 0;
+          _payload[wptr ++] = TKEY_BGATEWAYINFO_RES;
+          _payload[wptr ++] = pck->data[pck->data[0] + 1];
+          #ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+          uint16_t maxReplyLength = serializers_readUint16(pck->data, 3) - pck->data[0] - 2;
+          // each bus reports | TYPE | OWN_ADDRESS:2 | N_BYTES | OPEN_BITS:N_BYTES |, 
+          // one bit per address (1: open), 
+          const uint8_t bitBytes = (OSAP_BUSCONFIG_MAX_ADDRESSES + 7) / 8;
+          for(uint8_t i = startIndex; i < endIndex; i ++){
+            if(wptr + 4 + bitBytes > maxReplyLength) break;
+            if(i >= bgatewayCount) break;
+            if(bgateways[i] == nullptr){
+              _payload[wptr ++] = BGATEWAYTYPEKEY_NULL;
+              serializers_writeUint16(_payload, &wptr, 0);
+              _payload[wptr ++] = 0;
+            } else {
+              _payload[wptr ++] = bgateways[i]->typeKey;
+              serializers_writeUint16(_payload, &wptr, bgateways[i]->address);
+              _payload[wptr ++] = bitBytes;
+              memset(&(_payload[wptr]), 0, bitBytes);
+              for(uint16_t a = 0; a < OSAP_BUSCONFIG_MAX_ADDRESSES; a ++){
+                if(bgateways[i]->isOpen(a)) _payload[wptr + a / 8] |= (1 << (a % 8));
+              }
+              wptr += bitBytes;
+            }
+          }
+          #endif 
+          reply(pck, _payload, wptr);
+        }
+        break;
+      // -------------------- Runtime stats, 
+      case TKEY_STATS_REQ:
+        {
+          // | TKEY_STATS_REQ | ID | SELECT | START | END | 
+          // where SELECT is one of STATSKEY_RUNTIME, _PORTS, _LGATEWAYS 
+          // and start / end (inclusive, exclusive) apply to port / link pages, short ones are dropped, 
+          if(pck->len < (size_t)pck->data[0] + 5){
+            relinquishPacketToStack(pck);
+            break;
+          }
+          uint8_t select = pck->data[pck->data[0] + 2];
+          uint8_t startIndex = pck->data[pck->data[0] + 3];
+          uint8_t endIndex = pck->data[pck->data[0] + 4];
+          uint16_t wptr = 0;
+          _payload[wptr ++] = TKEY_STATS_RES;
+          _payload[wptr ++] = pck->data[pck->data[0] + 1];
+          _payload[wptr ++] = select;
+          // same max-length calc as the info-reqs, 
+          uint16_t maxReplyLength = serializers_readUint16(pck->data, 3) - pck->data[0] - 2;
+          switch(select){
+            case STATSKEY_RUNTIME:
+              // | stackSize | stackHighWater | timeouts:4 | badPorts:4 | badLinks:4 | badBusses:4 | slotCount | serviced:4 * slotCount |
+              // all-or-nothing, 
+              if(wptr + 19 + 4 * OSAP_STATS_SLOT_COUNT > maxReplyLength) break;
+              _payload[wptr ++] = stackSize;
+              _payload[wptr ++] = stackGetHighWaterMark();
+              serializers_writeUint32(_payload, &wptr, stats.timeouts);
+              serializers_writeUint32(_payload, &wptr, stats.badPortDrops);
+              serializers_writeUint32(_payload, &wptr, stats.badLinkDrops);
+              serializers_writeUint32(_payload, &wptr, stats.badBusDrops);
+              _payload[wptr ++] = OSAP_STATS_SLOT_COUNT;
+              for(uint8_t s = 0; s < OSAP_STATS_SLOT_COUNT; s ++){
+                serializers_writeUint32(_payload, &wptr, stats.serviced[s]);
+              }
+              break;
+            case STATSKEY_PORTS:
+              // | peakHold | per port, 
+              for(uint8_t i = startIndex; i < endIndex; i ++){
+                if(wptr > maxReplyLength) break;
+                if(i >= portCount) break;
+                _payload[wptr ++] = (ports[i] == nullptr) ? 0 : ports[i]->peakPacketHold;
+              }
+              break;
+            case STATSKEY_LGATEWAYS:
+              // | peakHold | bytesIn:4 | bytesOut:4 | per link, 
+              for(uint8_t i = startIndex; i < endIndex; i ++){
+                if(wptr + 9 > maxReplyLength) break;
+                if(i >= lgatewayCount) break;
+                if(lgateways[i] == nullptr){
+                  _payload[wptr ++] = 0;
+                  serializers_writeUint32(_payload, &wptr, 0);
+                  serializers_writeUint32(_payload, &wptr, 0);
+                } else {
+                  _payload[wptr ++] = lgateways[i]->peakPacketHold;
+                  serializers_writeUint32(_payload, &wptr, lgateways[i]->bytesIn);
+                  serializers_writeUint32(_payload, &wptr, lgateways[i]->bytesOut);
+                }
+              }
+              break;
+            #ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+            case STATSKEY_BGATEWAYS:
+              // | peakHold | bytesIn:4 | bytesOut:4 | per bus, as w/ links 
+              for(uint8_t i = startIndex; i < endIndex; i ++){
+                if(wptr + 9 > maxReplyLength) break;
+                if(i >= bgatewayCount) break;
+                if(bgateways[i] == nullptr){
+                  _payload[wptr ++] = 0;
+                  serializers_writeUint32(_payload, &wptr, 0);
+                  serializers_writeUint32(_payload, &wptr, 0);
+                } else {
+                  _payload[wptr ++] = bgateways[i]->peakPacketHold;
+                  serializers_writeUint32(_payload, &wptr, bgateways[i]->bytesIn);
+                  serializers_writeUint32(_payload, &wptr, bgateways[i]->bytesOut);
+                }
+              }
+              break;
+            #endif 
+            default:
+              OSAP_LOG(LOGCODE_BAD_STATS_SELECT, select);
+              break;
+          }
+          reply(pck, _payload, wptr);
+        }
+        break;
+      // -------------------- Everything-at-once graph discovery, 
+      case TKEY_DISCOVER_REQ:
+        discover(pck);
+        break;
+      // -------------------- Code-log, 
+      case TKEY_LOG_REQ:
+        {
+          // | TKEY_LOG_REQ | ID | FROM:4 | 
+          // | TKEY_LOG_RES | ID | HEAD:4 | FIRST:4 | DROPPED:4 | COUNT | RECORD:8 * COUNT | 
+          // from, head and first are absolute record indices, see utils/log.h, short requests are dropped, 
+          if(pck->len < (size_t)pck->data[0] + 6){
+            relinquishPacketToStack(pck);
+            break;
+          }
+          uint32_t from = serializers_readUint32(pck->data, pck->data[0] + 2);
+          uint32_t head = logGetHead();
+          uint32_t oldest = head > OSAP_CONFIG_LOG_LENGTH ? head - OSAP_CONFIG_LOG_LENGTH : 0;
+          if(from < oldest) from = oldest;
+          uint16_t wptr = 0;
+          _payload[wptr ++] = TKEY_LOG_RES;
+          _payload[wptr ++] = pck->data[pck->data[0] + 1];
+          serializers_writeUint32(_payload, &wptr, head);
+          serializers_writeUint32(_payload, &wptr, from);
+          serializers_writeUint32(_payload, &wptr, logGetDropped());
+          uint16_t countPtr = wptr ++;
+          uint16_t maxReplyLength = serializers_readUint16(pck->data, 3) - pck->data[0] - 2;
+          uint8_t count = 0;
+          while(wptr + OSAP_LOG_RECORD_SIZE <= maxReplyLength && from + count < head){
+            if(!logRead(from + count, &(_payload[wptr]))) break;
+            wptr += OSAP_LOG_RECORD_SIZE;
+            count ++;
+          }
+          _payload[countPtr] = count;
+          reply(pck, _payload, wptr);
+        }
+        break;
+      // -------------------- Resolutions to our own discovery requests, 
+      // DISCOVER to walk, RUNTIMEINFO to check snapshots, 
+      case TKEY_DISCOVER_RES:
+      case TKEY_RUNTIMEINFO_RES:
+        if(traversal != nullptr){
+          traversal->onResponse(pck);
+        } else {
+          OSAP_LOG(LOGCODE_INFO_RES_UNEXPECTED, pck->data[pck->data[0]]);
+        }
         relinquishPacketToStack(pck);
         break;
       // -------------------- Resolutions to graph discovery requests, 
-      // though we've not yet written the request-issuers in embedded, 
-      // so rx'ing one of these would mean an error someplace else, 
-      case TKEY_RUNTIMEINFO_RES:
+      // the embedded traversal doesn't issue these, so rx'ing one 
+      // would mean an error someplace else, 
       case TKEY_LGATEWAYINFO_RES:
       case TKEY_BGATEWAYINFO_RES:
-        OSAP_ERROR("not-yet issuing scope/state reqs from embedded, rx'd res");
+      case TKEY_STATS_RES:
+      case TKEY_LOG_RES:
+        OSAP_LOG(LOGCODE_INFO_RES_UNEXPECTED, pck->data[pck->data[0]]);
         relinquishPacketToStack(pck);
         break;
       default:
-        OSAP_ERROR("unlikely TKEY in loop: " + String(pck->data[pck->data[0]]));
+        OSAP_LOG(LOGCODE_BAD_TKEY, pck->data[pck->data[0]]);
         relinquishPacketToStack(pck);
         break;
     }
+    if(!awaiting) stats.serviced[slot] ++;
   } // end for p-in-packets, 
+  OSAP_TRACE(TRACE_EVT_LOOP_EXIT, 0, count);
+}
+
+void OSAP_Runtime::deliver(VPacket* pck, uint16_t payloadStart, uint16_t sourceIndex, uint16_t destinationIndex){
+  // copy the datagram out, since packet might be re-allocated
+  // during the func call: 
+  size_t payloadLen = pck->len - payloadStart;
+  memcpy(_payload, &(pck->data[payloadStart]), payloadLen);
+  // now we can dooo
+  // (1) de-allocate the packet, means we have guaranteed-clear space 
+  // if the func call below wants to re-allocate: 
+  relinquishPacketToStack(pck);
+  // (2) call the func
+  OSAP_TRACE(TRACE_EVT_ONPACKET_ENTER, 0, destinationIndex);
+  ports[destinationIndex]->onPacket(_payload, payloadLen, &_route, sourceIndex);
+  OSAP_TRACE(TRACE_EVT_ONPACKET_EXIT, 0, destinationIndex);
+}
+
+#ifdef OSAP_CONFIG_INCLUDE_ROUTE_IDS
+boolean OSAP_Runtime::serviceRouteID(VPacket* pck){
+  uint16_t ptr = pck->data[0];
+  uint8_t key = pck->data[ptr];
+  // installs key on the previous hop's | LINKF_RI | ingress:2 | label:2 |, 
+  // the origin has already made its own entry, 
+  boolean upstream = (ptr > 5 && pck->data[ptr - TKEY_LINKF_RI_INC] == TKEY_LINKF_RI);
+  uint16_t ingress = upstream ? serializers_readUint16(pck->data, ptr - 4) : ROUTEID_INGRESS_LOCAL;
+  uint16_t upstreamLabel = upstream ? serializers_readUint16(pck->data, ptr - 2) : 0;
+  // what's to be done, 
+  uint16_t label = ROUTEID_NONE;
+  uint8_t action = TKEY_LINKF;
+  uint16_t a = 0;
+  uint16_t b = 0;
+  switch(key){
+    case TKEY_RIDF:
+      {
+        // | TKEY_RIDF | label |, keyed w/ the link it came in on (or none, from our own ports), 
+        uint16_t inLabel = pck->data[ptr + 1];
+        if(pck->lgateway == nullptr){
+          RouteIDEntry* entry = routeIdGet(inLabel);
+          if(pck->vport != nullptr && entry != nullptr && entry->ingress == ROUTEID_INGRESS_LOCAL) label = inLabel;
+        } else {
+          label = routeIdFind(pck->lgateway->getIndex(), inLabel);
+        }
+        if(label == ROUTEID_NONE){
+          // evicted, or never installed: the sender will re-install soon, 
+          OSAP_LOG(LOGCODE_ROUTEID_MISS, inLabel);
+          relinquishPacketToStack(pck);
+          return true;
+        }
+        RouteIDEntry* entry = routeIdGet(label);
+        action = entry->key;
+        a = entry->a;
+        b = entry->b;
+      }
+      break;
+    case TKEY_LINKF_RI:
+      a = serializers_readUint16(pck->data, ptr + 1);
+      break;
+    case TKEY_PORTPACK_RI:
+      action = TKEY_PORTPACK;
+      a = serializers_readUint16(pck->data, ptr + 1);
+      b = serializers_readUint16(pck->data, ptr + 3);
+      break;
+  }
+  // to a port, 
+  if(action == TKEY_PORTPACK){
+    if(b >= portCount || ports[b] == nullptr){
+      OSAP_LOG(LOGCODE_PORTPACK_BAD_PORT, b);
+      stats.badPortDrops ++;
+      relinquishPacketToStack(pck);
+      return true;
+    }
+    RouteIDEntry* entry;
+    if(key == TKEY_PORTPACK_RI){
+      // the plain, reversed path, which we also keep for later labels, 
+      getRouteFromPacket(pck, &_route);
+      routeIdStrip(&_route);
+      _route.reverse();
+      if(upstream){
+        label = routeIdInstall(ingress, upstreamLabel);
+        entry = routeIdGet(label);
+        entry->key = TKEY_PORTPACK;
+        entry->a = a;
+        entry->b = b;
+        memcpy(entry->reversePath, _route.encodedPath, _route.encodedPathLen);
+        entry->reversePathLen = _route.encodedPathLen;
+      }
+    } else {
+      entry = routeIdGet(label);
+      entry->lastUsed = millis();
+      _route.perHopTimeToLive = serializers_readUint16(pck->data, 1);
+      _route.maxSegmentSize = serializers_readUint16(pck->data, 3);
+      memcpy(_route.encodedPath, entry->reversePath, entry->reversePathLen);
+      _route.encodedPathLen = entry->reversePathLen;
+    }
+    deliver(pck, ptr + ((key == TKEY_RIDF) ? TKEY_RIDF_INC : 5), a, b);
+    return true;
+  }
+  // or along a link, 
+  if(a >= lgatewayCount || lgateways[a] == nullptr){
+    OSAP_LOG(LOGCODE_LINKF_BAD_LINK, a);
+    stats.badLinkDrops ++;
+    relinquishPacketToStack(pck);
+    return true;
+  }
+  if(!fitToLink(pck, lgateways[a])) return true;
+  // awaiting (!) 
+  if(!lgateways[a]->clearToSend()) return false;
+  // swap in our label, 
+  uint16_t wptr = ptr + 3;
+  if(key == TKEY_LINKF_RI){
+    if(upstream){
+      label = routeIdInstall(ingress, upstreamLabel);
+      RouteIDEntry* entry = routeIdGet(label);
+      entry->key = TKEY_LINKF;
+      entry->a = a;
+      serializers_writeUint16(pck->data, &wptr, label);
+    }
+  } else {
+    routeIdGet(label)->lastUsed = millis();
+    pck->data[ptr + 1] = label;
+  }
+  OSAP_TRACE(TRACE_EVT_SEND, key, a);
+  lgateways[a]->send(pck->data, pck->len);
+  lgateways[a]->bytesOut += pck->len;
+  relinquishPacketToStack(pck);
+  return true;
+}
+#endif 
+
+boolean OSAP_Runtime::fitToLink(VPacket* pck, LGateway* link){
+  uint16_t mtu = link->getMTU();
+  if(pck->len > mtu){
+    OSAP_LOG(LOGCODE_LINKF_OVERSIZE, pck->len);
+    stats.badLinkDrops ++;
+    relinquishPacketToStack(pck);
+    return false;
+  }
+  if(serializers_readUint16(pck->data, 3) > mtu){
+    uint16_t wptr = 3;
+    serializers_writeUint16(pck->data, &wptr, mtu);
+  }
+  return true;
+}
+
+boolean OSAP_Runtime::isFirstHopOpen(Route* route){
+  if(route->encodedPathLen == 0) return true;
+  switch(route->encodedPath[0]){
+    case TKEY_LINKF:
+    case TKEY_LINKF_S:
+      {
+        uint16_t index = (route->encodedPath[0] == TKEY_LINKF) ? 
+          serializers_readUint16(route->encodedPath, 1) : route->encodedPath[1];
+        if(index >= lgatewayCount || lgateways[index] == nullptr) return false;
+        return lgateways[index]->isOpen();
+      }
+    #ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+    case TKEY_BUSF:
+      {
+        uint16_t index = serializers_readUint16(route->encodedPath, 1);
+        if(index >= bgatewayCount || bgateways[index] == nullptr) return false;
+        return bgateways[index]->isOpen(serializers_readUint16(route->encodedPath, 3));
+      }
+    #endif 
+    default:
+      return true;
+  }
+}
+
+void OSAP_Runtime::fitRoute(Route* route){
+  if(route->encodedPathLen == 0) return;
+  if(route->encodedPath[0] != TKEY_LINKF && route->encodedPath[0] != TKEY_LINKF_S) return;
+  uint16_t index = (route->encodedPath[0] == TKEY_LINKF) ? 
+    serializers_readUint16(route->encodedPath, 1) : route->encodedPath[1];
+  if(index >= lgatewayCount || lgateways[index] == nullptr) return;
+  uint16_t mtu = lgateways[index]->getMTU();
+  if(route->maxSegmentSize > mtu) route->maxSegmentSize = mtu;
+}
+
+size_t OSAP_Runtime::writeRuntimeInfo(VPacket* pck, uint8_t* traverseID, uint8_t* dest){
+  // traverseID handoff:
+  // copy-old into reply, 
+  memcpy(&(dest[0]), previousTraverseID, 4);
+  // copy-new into stash: 
+  memcpy(previousTraverseID, traverseID, 4);
+  // report build-type, 
+  dest[4] = BTYPEKEY_EMBEDDED_CPP;
+  // osap-version, 
+  dest[5] = OSAP_VERSION_MAJOR;
+  dest[6] = OSAP_VERSION_MID;
+  dest[7] = OSAP_VERSION_MINOR;
+  // we stuff the instruction we arrived on in here, (the route's last, reversed) 
+  // since the scanner will be reconstructing the graph, 
+  // they need to know how tf this mf' entered this rt, so we do:
+  uint16_t entry = routeLastInstruction(pck->data, pck->len);
+  // it *might* be from-ourselves, though probably not for some time, 
+  // in which case there's no instruction, and the rest of the field is zeroes: 
+  memset(&(dest[8]), 0, 5);
+  if(entry > 0 && entry < pck->data[0]){
+    // we can copy-pasta up-to 5 of these bytos, it ends at our pointer:
+    size_t entryLen = pck->data[0] - entry;
+    memcpy(&(dest[8]), &(pck->data[entry]), (entryLen > 5) ? 5 : entryLen);
+  }
+  // ports-count, links-count, busses-count, 
+  serializers_writeUint16(dest, 13, portCount);
+  serializers_writeUint16(dest, 15, lgatewayCount);
+  serializers_writeUint16(dest, 17, bgatewayCount);
+  // and the epoch, so scanners can skip us if we haven't changed, 
+  uint16_t wptr = 19;
+  serializers_writeUint32(dest, &wptr, getEpoch());
+  serializers_writeUint32(dest, &wptr, getSignature());
+  return OSAP_RUNTIMEINFO_LEN;
+}
+
+// scanners would otherwise do RUNTIMEINFO, PORTINFO pages, LGATEWAYINFO, and a name-req 
+// to every named port: this rolls all of that into as few segment-sized replies as we can, 
+// | TKEY_DISCOVER_REQ | ID | TRAVERSEID:4 | SECTION | CURSOR:2 | 
+// | TKEY_DISCOVER_RES | ID | CHUNK * N | TAIL | 
+// where each chunk is | SECTION | START:2 | COUNT:2 | ITEM * COUNT |, w/ items: 
+// - DISCOVERKEY_RUNTIME: the RUNTIMEINFO_RES body, only ever START 0 COUNT 1 
+// - DISCOVERKEY_PORTS: | TYPE | NNAMES | NAME\0 * NNAMES | 
+// - DISCOVERKEY_LGATEWAYS: | TYPE | OPEN | MTU:2 |, as in LGATEWAYINFO 
+// - DISCOVERKEY_BGATEWAYS: | TYPE | ADDRESS:2 | 
+// and the tail is | DISCOVERKEY_END | or | DISCOVERKEY_CONTINUE | SECTION | CURSOR:2 |, 
+// which the scanner echoes into its next request, the first request is SECTION 0, CURSOR 0, 
+// items too large for a page on their own (i.e. a port w/ very long names) are skipped, 
+// so a chunk's START can be past the last page's CURSOR 
+void OSAP_Runtime::discover(VPacket* pck){
+  uint16_t rptr = pck->data[0] + 1;
+  uint8_t id = pck->data[rptr ++];
+  uint8_t* traverseID = &(pck->data[rptr]);
+  rptr += 4;
+  uint8_t section = pck->data[rptr ++];
+  uint16_t cursor = serializers_readUint16(pck->data, rptr);
+  if(section < DISCOVERKEY_RUNTIME) section = DISCOVERKEY_RUNTIME;
+  // reserve space for the longest tail, 
+  uint16_t maxLen = serializers_readUint16(pck->data, 3) - pck->data[0] - 2 - 4;
+  uint16_t wptr = 0;
+  _payload[wptr ++] = TKEY_DISCOVER_RES;
+  _payload[wptr ++] = id;
+  // we walk sections in-order, each one filling from cursor until we run out of space, 
+  while(section < DISCOVERKEY_CONTINUE){
+    // count of items in this section, 
+    uint16_t total = 0;
+    switch(section){
+      case DISCOVERKEY_RUNTIME: total = 1; break;
+      case DISCOVERKEY_PORTS: total = portCount; break;
+      case DISCOVERKEY_LGATEWAYS: total = lgatewayCount; break;
+      case DISCOVERKEY_BGATEWAYS: total = bgatewayCount; break;
+    }
+    // chunk header, if we have anything to write and the space to write something, 
+    if(cursor < total){
+      if(wptr + 5 > maxLen) break;
+      uint16_t chunkStart = wptr;
+      _payload[wptr ++] = section;
+      serializers_writeUint16(_payload, &wptr, cursor);
+      uint16_t countPtr = wptr;
+      wptr += 2;
+      uint16_t count = 0;
+      while(cursor < total){
+        // figure the item's size before we write it, 
+        size_t itemLen = 0;
+        switch(section){
+          case DISCOVERKEY_RUNTIME: 
+            itemLen = OSAP_RUNTIMEINFO_LEN; 
+            break;
+          case DISCOVERKEY_PORTS: 
+            itemLen = 2;
+            if(ports[cursor] != nullptr){
+              const char* name;
+              for(uint8_t n = 0; (name = ports[cursor]->getName(n)) != nullptr; n ++){
+                itemLen += strlen(name) + 1;
+              }
+            }
+            break;
+          case DISCOVERKEY_LGATEWAYS: 
+            itemLen = 4; 
+            break;
+          case DISCOVERKEY_BGATEWAYS: 
+            itemLen = 3; 
+            break;
+        }
+        if(wptr + itemLen > maxLen){
+          // an item that doesn't fit in an otherwise-empty page never will: skip it, 
+          // (restarting the chunk after it) rather than have the scanner ask for it forever 
+          if(count == 0 && chunkStart == 2){
+            OSAP_LOG(LOGCODE_DISCOVER_SKIPPED, (section << 8) | cursor);
+            cursor ++;
+            serializers_writeUint16(_payload, chunkStart + 1, cursor);
+            continue;
+          }
+          break;
+        }
+        // and write it, 
+        switch(section){
+          case DISCOVERKEY_RUNTIME: 
+            wptr += writeRuntimeInfo(pck, traverseID, &(_payload[wptr]));
+            break;
+          case DISCOVERKEY_PORTS: 
+            if(ports[cursor] == nullptr){
+              _payload[wptr ++] = PTYPEKEY_NULL;
+              _payload[wptr ++] = 0;
+            } else {
+              _payload[wptr ++] = ports[cursor]->typeKey;
+              uint16_t nNamesPtr = wptr ++;
+              uint8_t n = 0;
+              const char* name;
+              while((name = ports[cursor]->getName(n)) != nullptr){
+                serializers_writeString(_payload, &wptr, (char*)name);
+                n ++;
+              }
+              _payload[nNamesPtr] = n;
+            }
+            break;
+          case DISCOVERKEY_LGATEWAYS: 
+            if(lgateways[cursor] == nullptr){
+              _payload[wptr ++] = LGATEWAYTYPEKEY_NULL;
+              _payload[wptr ++] = 0;
+              serializers_writeUint16(_payload, &wptr, 0);
+            } else {
+              _payload[wptr ++] = lgateways[cursor]->typeKey;
+              _payload[wptr ++] = lgateways[cursor]->isOpen() ? 1 : 0;
+              serializers_writeUint16(_payload, &wptr, lgateways[cursor]->getMTU());
+            }
+            break;
+          case DISCOVERKEY_BGATEWAYS: 
+            #ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+            if(bgateways[cursor] != nullptr){
+              _payload[wptr ++] = bgateways[cursor]->typeKey;
+              serializers_writeUint16(_payload, &wptr, bgateways[cursor]->address);
+              break;
+            }
+            #endif 
+            _payload[wptr ++] = BGATEWAYTYPEKEY_NULL;
+            serializers_writeUint16(_payload, &wptr, 0);
+            break;
+        }
+        cursor ++;
+        count ++;
+      }
+      // un-write empty chunks, else stash the count 
+      if(count == 0){
+        wptr = chunkStart;
+        break;
+      }
+      serializers_writeUint16(_payload, countPtr, count);
+      // if we broke out early, we're full 
+      if(cursor < total) break;
+    }
+    // next section, 
+    section ++;
+    cursor = 0;
+  }
+  // write the tail, 
+  if(section < DISCOVERKEY_CONTINUE){
+    _payload[wptr ++] = DISCOVERKEY_CONTINUE;
+    _payload[wptr ++] = section;
+    serializers_writeUint16(_payload, &wptr, cursor);
+  } else {
+    _payload[wptr ++] = DISCOVERKEY_END;
+  }
+  reply(pck, _payload, wptr);
 }
 
 void OSAP_Runtime::reply(VPacket* pck, uint8_t* data, size_t len){
@@ -295,16 +995,26 @@ void OSAP_Runtime::attachDebugFunction(void (*_printFuncPtr)(String)){
   OSAP_Runtime::printFuncPtr = _printFuncPtr;
 }
 
-void OSAP_Runtime::error(String msg){
+void OSAP_Runtime::error(const String& msg){
   if(printFuncPtr == nullptr) return;
   OSAP_Runtime::printFuncPtr(msg);
 }
 
-void OSAP_Runtime::debug(String msg){
+void OSAP_Runtime::debug(const String& msg){
   if(printFuncPtr == nullptr) return;
   OSAP_Runtime::printFuncPtr(msg);
 }
 
+void OSAP_Runtime::error(const char* msg){
+  if(printFuncPtr == nullptr) return;
+  OSAP_Runtime::printFuncPtr(String(msg));
+}
+
+void OSAP_Runtime::debug(const char* msg){
+  if(printFuncPtr == nullptr) return;
+  OSAP_Runtime::printFuncPtr(String(msg));
+}
+
 #ifdef OSAP_CONFIG_INCLUDE_DEBUG_MSGS
 String OSAP_Runtime::printRoute(Route* route){
   String msg;
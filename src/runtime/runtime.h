@@ -12,6 +12,41 @@
 class VPacket;
 class VPort;
 class LGateway;
+class BGateway;
+class OSAP_Traversal;
+
+// length of the runtime-info body, 
+// | PREVTRAVERSEID:4 | BTYPE | VERSION:3 | ENTRY:5 | NPORTS:2 | NLGATEWAYS:2 | NBGATEWAYS:2 | EPOCH:4 | SIGNATURE:4 | 
+#define OSAP_RUNTIMEINFO_LEN 27 
+
+// ---------------------------------------------- Runtime Statistics 
+
+// we count serviced packets per transport key, but tkeys are sparse, 
+// so each is mapped into one of these slots (see runtime.cpp::statsKeySlot)
+#define OSAP_STATS_SLOT_LINKF 0 
+#define OSAP_STATS_SLOT_BUSF 1 
+#define OSAP_STATS_SLOT_PORTPACK 2 
+#define OSAP_STATS_SLOT_RUNTIMEINFO 3 
+#define OSAP_STATS_SLOT_PORTINFO 4 
+#define OSAP_STATS_SLOT_LGATEWAYINFO 5 
+#define OSAP_STATS_SLOT_BGATEWAYINFO 6 
+#define OSAP_STATS_SLOT_STATS 7 
+#define OSAP_STATS_SLOT_LOG 9 
+#define OSAP_STATS_SLOT_BUSB 10 
+#define OSAP_STATS_SLOT_DISCOVER 11 
+#define OSAP_STATS_SLOT_RIDF 12 
+#define OSAP_STATS_SLOT_OTHER 8 
+#define OSAP_STATS_SLOT_COUNT 13 
+
+// these are all plain increments in the runtime loop, 
+// cheap enough to leave on in every build 
+typedef struct OSAP_RuntimeStats {
+  uint32_t serviced[OSAP_STATS_SLOT_COUNT] = { 0 };
+  uint32_t timeouts = 0;
+  uint32_t badPortDrops = 0;
+  uint32_t badLinkDrops = 0;
+  uint32_t badBusDrops = 0;
+} OSAP_RuntimeStats;
 
 class OSAP_Runtime {
   public:
@@ -26,8 +61,11 @@ class OSAP_Runtime {
     // ute-aids, 
     void attachDebugFunction(void (*_printFuncPtr)(String));
     // and debug-'ers 
-    static void error(String msg);
-    static void debug(String msg);
+    static void error(const String& msg);
+    static void debug(const String& msg);
+    // literal-overloads don't build a String unless something is attached 
+    static void error(const char* msg);
+    static void debug(const char* msg);
 
     // big-debuggers we compile guard... 
     #ifdef OSAP_CONFIG_INCLUDE_DEBUG_MSGS
@@ -37,14 +75,41 @@ class OSAP_Runtime {
     // instance-getter, for singleton-ness, 
     static OSAP_Runtime* getInstance(void);
 
+    // topology / config epoch: scanners cache graphs against this and the signature, 
+    // anything that changes what a scan would see should call bumpEpoch(), 
+    // it only ever goes up while we're running, but starts over on reset unless seeded: 
+    // sketches that keep a boot count (in flash or eeprom) pass it here, before begin(), 
+    // and the epoch then starts from bootCount << 16, above anything reported in earlier boots 
+    void seedEpoch(uint32_t bootCount);
+    void bumpEpoch(void);
+    uint32_t getEpoch(void);
+    // and a hash of the structure (port types and names, link types) taken at begin(), 
+    // so that a re-flashed device doesn't alias a cached one 
+    uint32_t getSignature(void);
+
+    // true unless a route's first hop is a link (or bus drop) of ours that's closed, 
+    // i.e. for ports holding onto a reversed route, to notice that it's gone dead 
+    boolean isFirstHopOpen(Route* route);
+    // clamp a route's segment size to its first hop's MTU, where that's a link of ours, 
+    // packet-stuffing does this, so that originating packets fit and say what fits 
+    void fitRoute(Route* route);
+
     // lists ! 
     VPort* ports[OSAP_CONFIG_MAX_PORTS];
     uint16_t portCount = 0;
     LGateway* lgateways[OSAP_CONFIG_MAX_LGATEWAYS];
     uint16_t lgatewayCount = 0;
-    // BGateway* bgateways[OSAP_CONFIG_MAX_BGATEWAYS];
+    #ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+    BGateway* bgateways[OSAP_CONFIG_MAX_BGATEWAYS];
+    #endif 
     uint16_t bgatewayCount = 0;
 
+    // counters, see TKEY_STATS_REQ 
+    OSAP_RuntimeStats stats;
+
+    // an embedded graph-scanner, if one is instantiated, 
+    OSAP_Traversal* traversal = nullptr;
+
   private:
     // only one among us 
     static OSAP_Runtime* instance;
@@ -62,11 +127,38 @@ class OSAP_Runtime {
     // so that traversers can connect dots... it's four random bytes 
     uint8_t previousTraverseID[4] = { 0, 0, 0, 0 };
 
+    // the epoch counts changes: registrations, renames, links opening / closing, 
+    // and the signature is the structure's, see getSignature() 
+    uint32_t epoch = 0;
+    uint32_t signature = 0;
+    // link open-states as of last loop, to catch changes, 
+    uint32_t lgatewayOpenBits = 0;
+
+    // hands a packet's payload to one of our ports, w/ the (reversed) source route in _route, 
+    void deliver(VPacket* pck, uint16_t payloadStart, uint16_t sourceIndex, uint16_t destinationIndex);
+
+    // before a packet goes out on a link: drops it if it's larger than the link's MTU, 
+    // and otherwise lowers its maxSegmentSize to that MTU, so that the MSS that 
+    // arrives (and is reversed into replies) is the minimum along the path 
+    boolean fitToLink(VPacket* pck, LGateway* link);
+
+    #ifdef OSAP_CONFIG_INCLUDE_ROUTE_IDS
+    // route-id instructions, see packets/route_ids.h, returns false if the packet is awaiting its link 
+    boolean serviceRouteID(VPacket* pck);
+    #endif 
+
     // local ute for transport-query replies, 
     // this stuffs replies back into the same packet-allocation, 
     // so we don't need to re-allocate stack, etc, 
     void reply(VPacket* pck, uint8_t* data, size_t len);
 
+    // writes the runtime-info body (shared by RUNTIMEINFO and DISCOVER replies) 
+    // into dest, swapping in the new traverseID, returns length written 
+    size_t writeRuntimeInfo(VPacket* pck, uint8_t* traverseID, uint8_t* dest);
+
+    // services TKEY_DISCOVER_REQ, see runtime.cpp 
+    void discover(VPacket* pck);
+
     // and those debug utes 
     static void (*printFuncPtr)(String);
 };
@@ -0,0 +1,130 @@
+/*
+osap/subscriptions.cpp
+
+ports that push samples, instead of being polled for them
+
+Jake Read at the Center for Bits and Atoms
+(c) Massachusetts Institute of Technology 2022
+
+This work may be reproduced, modified, distributed, performed, and
+displayed for any purpose, but must acknowledge the osap project.
+Copyright is retained and must be preserved. The work is provided as is;
+no warranty is provided, and users accept all liability.
+*/
+
+#include "subscriptions.h"
+#include "runtime.h"
+#include "../structure/ports.h"
+#include "../utils/serializers.h"
+#include "../utils/log.h"
+
+// | SUBSCRIBE | MSGID | MODE | PERIOD_MS:2 | LEASE_MS:2 |
+#define SUB_HEADER_LEN 7
+
+Subscription subscriptionSlots[OSAP_CONFIG_SUBSCRIPTION_SLOTS];
+
+// subscribers are who they are by msg id, port, and path: two hosts w/ the same port index
+// and msg id mustn't renew (or end) one another's,
+static Subscription* subscriptionFind(VPort* vport, uint8_t msgID, Route* route, uint16_t sourcePort){
+  for(uint8_t s = 0; s < OSAP_CONFIG_SUBSCRIPTION_SLOTS; s ++){
+    Subscription* sub = &(subscriptionSlots[s]);
+    if(sub->vport != vport || sub->msgID != msgID || sub->destinationPort != sourcePort) continue;
+    if(sub->route.encodedPathLen != route->encodedPathLen) continue;
+    if(memcmp(sub->route.encodedPath, route->encodedPath, route->encodedPathLen) != 0) continue;
+    return sub;
+  }
+  return nullptr;
+}
+
+boolean subscriptionOpen(VPort* vport, uint8_t pushKey, uint8_t* data, size_t len, Route* route, uint16_t sourcePort){
+  if(len < SUB_HEADER_LEN || len - SUB_HEADER_LEN > OSAP_CONFIG_SUBSCRIPTION_MAX_ARGS) return false;
+  if(data[2] != SUB_MODE_PERIODIC && data[2] != SUB_MODE_ON_CHANGE) return false;
+  // a renewal, or a new one,
+  Subscription* sub = subscriptionFind(vport, data[1], route, sourcePort);
+  if(sub == nullptr){
+    for(uint8_t s = 0; s < OSAP_CONFIG_SUBSCRIPTION_SLOTS && sub == nullptr; s ++){
+      if(subscriptionSlots[s].vport == nullptr) sub = &(subscriptionSlots[s]);
+    }
+    if(sub == nullptr){
+      OSAP_LOG(LOGCODE_SUB_FULL, data[1]);
+      return false;
+    }
+    sub->vport = vport;
+    sub->destinationPort = sourcePort;
+    sub->msgID = data[1];
+    sub->seq = 0;
+    sub->pushed = false;
+    // the first sample goes out right away,
+    sub->lastSample = millis() - serializers_readUint16(data, 3);
+  }
+  sub->route = *route;
+  sub->pushKey = pushKey;
+  sub->mode = data[2];
+  sub->period = serializers_readUint16(data, 3);
+  sub->lease = serializers_readUint16(data, 5);
+  sub->lastRenew = millis();
+  sub->argsLen = len - SUB_HEADER_LEN;
+  memcpy(sub->args, &(data[SUB_HEADER_LEN]), sub->argsLen);
+  return true;
+}
+
+void subscriptionClose(VPort* vport, uint8_t msgID, Route* route, uint16_t sourcePort){
+  Subscription* sub = subscriptionFind(vport, msgID, route, sourcePort);
+  if(sub != nullptr) sub->vport = nullptr;
+}
+
+static void subscriptionEnd(Subscription* sub, uint8_t reason){
+  OSAP_LOG(LOGCODE_SUB_ENDED, (reason << 8) | sub->msgID);
+  sub->vport = nullptr;
+}
+
+// fnv-1a, to notice changes w/o keeping the last sample around,
+static uint32_t subscriptionHash(uint8_t* data, size_t len){
+  uint32_t hash = 2166136261;
+  for(size_t i = 0; i < len; i ++){
+    hash ^= data[i];
+    hash *= 16777619;
+  }
+  return hash;
+}
+
+void subscriptionsLoop(void){
+  OSAP_Runtime* runtime = OSAP_Runtime::getInstance();
+  uint32_t now = millis();
+  for(uint8_t s = 0; s < OSAP_CONFIG_SUBSCRIPTION_SLOTS; s ++){
+    Subscription* sub = &(subscriptionSlots[s]);
+    if(sub->vport == nullptr) continue;
+    // is anyone still listening ?
+    if(sub->lease != 0 && now - sub->lastRenew > sub->lease){
+      subscriptionEnd(sub, SUB_END_LEASE);
+      continue;
+    }
+    if(!runtime->isFirstHopOpen(&(sub->route))){
+      subscriptionEnd(sub, SUB_END_ROUTE);
+      continue;
+    }
+    // is it time, and is there room ? if not, we try again next loop,
+    if(now - sub->lastSample < sub->period) continue;
+    if(!sub->vport->clearToSend()) continue;
+    sub->lastSample = now;
+    // the push is | PUSH | MSGID | SEQ | SAMPLE |, as long as replies on this route can be,
+    uint8_t* payload = VPort::_payload;
+    size_t maxLen = sub->route.maxPayload();
+    if(maxLen < 3) continue;
+    size_t len = 0;
+    if(!sub->vport->sample(sub->args, sub->argsLen, &(payload[3]), maxLen - 3, &len) || len > maxLen - 3){
+      subscriptionEnd(sub, SUB_END_SAMPLE);
+      continue;
+    }
+    if(sub->mode == SUB_MODE_ON_CHANGE){
+      uint32_t hash = subscriptionHash(&(payload[3]), len);
+      if(sub->pushed && hash == sub->lastHash) continue;
+      sub->lastHash = hash;
+    }
+    payload[0] = sub->pushKey;
+    payload[1] = sub->msgID;
+    payload[2] = sub->seq ++;
+    sub->vport->send(payload, len + 3, &(sub->route), sub->destinationPort);
+    sub->pushed = true;
+  }
+}
@@ -0,0 +1,75 @@
+/*
+osap/subscriptions.h
+
+ports that push samples, instead of being polled for them
+
+Jake Read at the Center for Bits and Atoms
+(c) Massachusetts Institute of Technology 2022
+
+This work may be reproduced, modified, distributed, performed, and
+displayed for any purpose, but must acknowledge the osap project.
+Copyright is retained and must be preserved. The work is provided as is;
+no warranty is provided, and users accept all liability.
+*/
+
+#ifndef OSAP_SUBSCRIPTIONS_H_
+#define OSAP_SUBSCRIPTIONS_H_
+
+#include <Arduino.h>
+#include "../packets/routes.h"
+
+class VPort;
+
+// a caller subscribes to a port w/ that port's SUBSCRIBE key, and then:
+// | SUBSCRIBE | MSGID | MODE | PERIOD_MS:2 | LEASE_MS:2 | ARGS... | -> | SUBRES | MSGID | OK |
+// after which the port samples itself (see VPort::sample) w/ those args, and pushes
+// | PUSH | MSGID | SEQ | SAMPLE... |
+// along the reversed route the subscription came in on, until
+// - the caller sends | UNSUBSCRIBE | MSGID |
+// - the lease runs out: callers re-send the same SUBSCRIBE to renew it, (a LEASE of 0 never runs out)
+// - the route's first hop (a link or bus drop of ours) closes
+// - or the port can't produce a sample w/ those args
+// n.b. we can only see our own first hop: if the subscriber goes away further along, 
+// pushes go out (and are dropped downstream) until the lease runs out, so subscribers 
+// more than a hop away should use a lease, and LEASE 0 is best kept for neighbours
+// the keys are each port's own, see port_rpc_helpers.h and port_named.h
+
+// every PERIOD_MS,
+#define SUB_MODE_PERIODIC 0
+// or, checking every PERIOD_MS, only when the sample is different from the last one pushed,
+#define SUB_MODE_ON_CHANGE 1
+
+// why a subscription ended, for LOGCODE_SUB_ENDED,
+#define SUB_END_LEASE 1
+#define SUB_END_ROUTE 2
+#define SUB_END_SAMPLE 3
+
+typedef struct Subscription {
+  VPort* vport = nullptr;
+  // the (reversed) route to the subscriber, and its port,
+  Route route;
+  uint16_t destinationPort = 0;
+  uint8_t msgID = 0;
+  uint8_t pushKey = 0;
+  uint8_t mode = SUB_MODE_PERIODIC;
+  uint16_t period = 0;
+  uint16_t lease = 0;
+  uint32_t lastSample = 0;
+  uint32_t lastRenew = 0;
+  uint8_t seq = 0;
+  // on-change compares a hash of each sample to the last one's,
+  boolean pushed = false;
+  uint32_t lastHash = 0;
+  uint8_t args[OSAP_CONFIG_SUBSCRIPTION_MAX_ARGS];
+  uint8_t argsLen = 0;
+} Subscription;
+
+// opens (or renews) a subscription from a | SUBSCRIBE | ... | msg, returning false if it's malformed,
+// or if we have no room for it,
+boolean subscriptionOpen(VPort* vport, uint8_t pushKey, uint8_t* data, size_t len, Route* route, uint16_t sourcePort);
+// ends it, from a | UNSUBSCRIBE | MSGID | sent along the same path,
+void subscriptionClose(VPort* vport, uint8_t msgID, Route* route, uint16_t sourcePort);
+// the runtime samples and pushes, and ends those that are done, once per loop
+void subscriptionsLoop(void);
+
+#endif
@@ -0,0 +1,512 @@
+// traversal ! 
+
+#include "traversal.h"
+#include "../packets/packets.h"
+#include "../utils/serializers.h"
+#include "../utils/log.h"
+
+OSAP_Traversal::OSAP_Traversal(void) : VPort(OSAP_Runtime::getInstance()){
+  typeKey = PTYPEKEY_TRAVERSAL;
+  // this is how many requests we can author at once, 
+  maxPacketHold = OSAP_CONFIG_TRAVERSAL_MAX_IN_FLIGHT;
+  // and the runtime hands us responses, 
+  OSAP_Runtime::getInstance()->traversal = this;
+}
+
+void OSAP_Traversal::onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort){
+  OSAP_LOG(LOGCODE_PORT_BAD_KEY, (typeKey << 8) | data[0]);
+}
+
+// ---------------------------------------------- User API 
+
+void OSAP_Traversal::newTraverseID(void){
+  // a new ID, so that runtimes we've seen in past traversals aren't dupes, 
+  uint32_t id = micros() ^ ((uint32_t)nodeCount << 16) ^ 0x5A5A5A5A;
+  for(uint8_t i = 0; i < 3; i ++){
+    traverseID[i] = (id >> (i * 8)) & 255;
+  }
+}
+
+void OSAP_Traversal::start(void){
+  newTraverseID();
+  // we are the root, 
+  nodes[0] = TraversalNode();
+  nodeCount = 1;
+  foundPortCount = 0;
+  foundGatewayCount = 0;
+  namePoolLen = 0;
+  inFlight = 0;
+}
+
+boolean OSAP_Traversal::isVerified(void){
+  for(uint8_t n = 0; n < nodeCount; n ++){
+    if(nodes[n].state == TRAVERSAL_NODE_STALE || nodes[n].state == TRAVERSAL_NODE_VERIFYING) return false;
+  }
+  return true;
+}
+
+boolean OSAP_Traversal::isChanged(void){
+  for(uint8_t n = 0; n < nodeCount; n ++){
+    if(nodes[n].state == TRAVERSAL_NODE_CHANGED) return true;
+  }
+  return false;
+}
+
+boolean OSAP_Traversal::isDone(void){
+  if(nodeCount == 0) return false;
+  for(uint8_t n = 0; n < nodeCount; n ++){
+    if(nodes[n].state == TRAVERSAL_NODE_QUEUED || nodes[n].state == TRAVERSAL_NODE_AWAITING) return false;
+  }
+  return true;
+}
+
+void OSAP_Traversal::getNodeRoute(uint8_t node, Route* route){
+  uint8_t start = node;
+  // walk up, collecting exits in reverse, 
+  uint8_t exits[OSAP_CONFIG_TRAVERSAL_MAX_DEPTH];
+  uint8_t depth = 0;
+  while(node != 0 && node != TRAVERSAL_NO_PARENT && depth < OSAP_CONFIG_TRAVERSAL_MAX_DEPTH){
+    exits[depth ++] = nodes[node].exitLink;
+    node = nodes[node].parent;
+  }
+  // and write them forwards, 
+  route->encodedPathLen = 0;
+  while(depth > 0){
+    route->linkf(exits[-- depth]);
+  }
+  route->end();
+  // every runtime past us has to read the short keys, we read our own, 
+  boolean shortKeys = true;
+  while(start != 0 && start != TRAVERSAL_NO_PARENT){
+    if(!nodes[start].shortKeys) shortKeys = false;
+    start = nodes[start].parent;
+  }
+  if(shortKeys) route->shorten();
+}
+
+boolean OSAP_Traversal::findPort(const char* name, Route* route, uint16_t* portIndex){
+  for(uint16_t p = 0; p < foundPortCount; p ++){
+    TraversalPort* port = &(foundPorts[p]);
+    if((port->name != TRAVERSAL_NO_NAME && strcmp(getPoolName(port->name), name) == 0) || 
+       (port->secondName != TRAVERSAL_NO_NAME && strcmp(getPoolName(port->secondName), name) == 0)){
+      getNodeRoute(port->node, route);
+      *portIndex = port->index;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* OSAP_Traversal::getPoolName(uint16_t offset){
+  return &(namePool[offset]);
+}
+
+uint16_t OSAP_Traversal::poolString(const char* str){
+  size_t len = strlen(str) + 1;
+  if(namePoolLen + len > OSAP_CONFIG_TRAVERSAL_NAME_POOL) return TRAVERSAL_NO_NAME;
+  uint16_t offset = namePoolLen;
+  memcpy(&(namePool[offset]), str, len);
+  namePoolLen += len;
+  return offset;
+}
+
+TraversalGateway* OSAP_Traversal::addGateway(uint8_t node, uint8_t kind, uint16_t index){
+  if(foundGatewayCount >= OSAP_CONFIG_TRAVERSAL_MAX_GATEWAYS) return nullptr;
+  TraversalGateway* gateway = &(foundGateways[foundGatewayCount ++]);
+  *gateway = TraversalGateway();
+  gateway->node = node;
+  gateway->kind = kind;
+  gateway->index = index;
+  return gateway;
+}
+
+// ---------------------------------------------- Snapshots 
+
+size_t OSAP_Traversal::writeSnapshot(uint8_t* dest, size_t maxLen){
+  // routes first, so we know how long the pool is, 
+  uint16_t routePoolLen = 0;
+  Route route;
+  for(uint8_t n = 0; n < nodeCount; n ++){
+    getNodeRoute(n, &route);
+    routePoolLen += route.encodedPathLen;
+  }
+  size_t len = TRAVERSAL_SNAPSHOT_HEADER_LEN + nodeCount * TRAVERSAL_SNAPSHOT_NODE_LEN + 
+    foundPortCount * TRAVERSAL_SNAPSHOT_PORT_LEN + foundGatewayCount * TRAVERSAL_SNAPSHOT_GATEWAY_LEN + 
+    routePoolLen + namePoolLen;
+  if(len > maxLen) return 0;
+  // header, 
+  uint16_t wptr = 0;
+  serializers_writeUint32(dest, &wptr, TRAVERSAL_SNAPSHOT_MAGIC);
+  dest[wptr ++] = TRAVERSAL_SNAPSHOT_VERSION;
+  dest[wptr ++] = nodeCount;
+  serializers_writeUint16(dest, &wptr, foundPortCount);
+  serializers_writeUint16(dest, &wptr, foundGatewayCount);
+  serializers_writeUint16(dest, &wptr, routePoolLen);
+  serializers_writeUint16(dest, &wptr, namePoolLen);
+  serializers_writeUint32(dest, &wptr, len);
+  // nodes, w/ routes written into the pool as we go, 
+  uint16_t routePtr = wptr + nodeCount * TRAVERSAL_SNAPSHOT_NODE_LEN + foundPortCount * TRAVERSAL_SNAPSHOT_PORT_LEN + 
+    foundGatewayCount * TRAVERSAL_SNAPSHOT_GATEWAY_LEN;
+  uint16_t routeOffset = 0;
+  for(uint8_t n = 0; n < nodeCount; n ++){
+    TraversalNode* node = &(nodes[n]);
+    getNodeRoute(n, &route);
+    dest[wptr ++] = node->parent;
+    dest[wptr ++] = node->exitLink;
+    dest[wptr ++] = node->depth;
+    dest[wptr ++] = node->state;
+    serializers_writeUint16(dest, &wptr, node->entryLink);
+    serializers_writeUint16(dest, &wptr, routeOffset);
+    dest[wptr ++] = route.encodedPathLen;
+    dest[wptr ++] = node->shortKeys ? 1 : 0;
+    dest[wptr ++] = node->linkMTUs ? 1 : 0;
+    dest[wptr ++] = 0;
+    serializers_writeUint32(dest, &wptr, node->epoch);
+    serializers_writeUint32(dest, &wptr, node->signature);
+    memcpy(&(dest[routePtr + routeOffset]), route.encodedPath, route.encodedPathLen);
+    routeOffset += route.encodedPathLen;
+  }
+  // ports, 
+  for(uint16_t p = 0; p < foundPortCount; p ++){
+    TraversalPort* port = &(foundPorts[p]);
+    dest[wptr ++] = port->node;
+    dest[wptr ++] = port->typeKey;
+    serializers_writeUint16(dest, &wptr, port->index);
+    serializers_writeUint16(dest, &wptr, port->name);
+    serializers_writeUint16(dest, &wptr, port->secondName);
+  }
+  // gateways, 
+  for(uint16_t g = 0; g < foundGatewayCount; g ++){
+    TraversalGateway* gateway = &(foundGateways[g]);
+    dest[wptr ++] = gateway->node;
+    dest[wptr ++] = gateway->kind;
+    dest[wptr ++] = gateway->typeKey;
+    dest[wptr ++] = gateway->open;
+    serializers_writeUint16(dest, &wptr, gateway->index);
+    serializers_writeUint16(dest, &wptr, gateway->mtu);
+    serializers_writeUint16(dest, &wptr, gateway->address);
+  }
+  // and names, verbatim, 
+  memcpy(&(dest[routePtr + routePoolLen]), namePool, namePoolLen);
+  return len;
+}
+
+boolean OSAP_Traversal::loadSnapshot(const uint8_t* src, size_t len){
+  // check the header before we touch the table, 
+  if(len < TRAVERSAL_SNAPSHOT_HEADER_LEN) return false;
+  uint8_t* buf = (uint8_t*)src;
+  if(serializers_readUint32(buf, 0) != TRAVERSAL_SNAPSHOT_MAGIC) return false;
+  if(buf[4] != TRAVERSAL_SNAPSHOT_VERSION) return false;
+  uint8_t nNodes = buf[5];
+  uint16_t nPorts = serializers_readUint16(buf, 6);
+  uint16_t nGateways = serializers_readUint16(buf, 8);
+  uint16_t routePoolLen = serializers_readUint16(buf, 10);
+  uint16_t nameLen = serializers_readUint16(buf, 12);
+  if(serializers_readUint32(buf, 14) != len) return false;
+  if(nNodes == 0 || nNodes > OSAP_CONFIG_TRAVERSAL_MAX_NODES) return false;
+  if(nPorts > OSAP_CONFIG_TRAVERSAL_MAX_PORTS || nameLen > OSAP_CONFIG_TRAVERSAL_NAME_POOL) return false;
+  if(nGateways > OSAP_CONFIG_TRAVERSAL_MAX_GATEWAYS) return false;
+  if((size_t)(TRAVERSAL_SNAPSHOT_HEADER_LEN + nNodes * TRAVERSAL_SNAPSHOT_NODE_LEN + 
+    nPorts * TRAVERSAL_SNAPSHOT_PORT_LEN + nGateways * TRAVERSAL_SNAPSHOT_GATEWAY_LEN + 
+    routePoolLen + nameLen) != len) return false;
+  // past here we overwrite the table, so failures leave it empty, 
+  nodeCount = 0;
+  foundPortCount = 0;
+  foundGatewayCount = 0;
+  namePoolLen = 0;
+  // nodes, we re-derive routes from parents, so the route pool is only for other readers, 
+  uint16_t rptr = TRAVERSAL_SNAPSHOT_HEADER_LEN;
+  for(uint8_t n = 0; n < nNodes; n ++){
+    TraversalNode* node = &(nodes[n]);
+    *node = TraversalNode();
+    node->parent = buf[rptr];
+    node->exitLink = buf[rptr + 1];
+    node->depth = buf[rptr + 2];
+    node->entryLink = serializers_readUint16(buf, rptr + 4);
+    node->shortKeys = (buf[rptr + 9] != 0);
+    node->linkMTUs = (buf[rptr + 10] != 0);
+    node->epoch = serializers_readUint32(buf, rptr + 12);
+    node->signature = serializers_readUint32(buf, rptr + 16);
+    // anything that was whole in the snapshot gets checked again, 
+    switch(buf[rptr + 3]){
+      case TRAVERSAL_NODE_DONE:
+      case TRAVERSAL_NODE_STALE:
+      case TRAVERSAL_NODE_VERIFYING:
+      case TRAVERSAL_NODE_CHANGED:
+        node->state = TRAVERSAL_NODE_STALE;
+        break;
+      default:
+        node->state = TRAVERSAL_NODE_FAILED;
+        break;
+    }
+    if(n > 0 && (node->parent >= n || node->depth > OSAP_CONFIG_TRAVERSAL_MAX_DEPTH)) return false;
+    rptr += TRAVERSAL_SNAPSHOT_NODE_LEN;
+  }
+  // ports, 
+  for(uint16_t p = 0; p < nPorts; p ++){
+    TraversalPort* port = &(foundPorts[p]);
+    port->node = buf[rptr];
+    port->typeKey = buf[rptr + 1];
+    port->index = serializers_readUint16(buf, rptr + 2);
+    port->name = serializers_readUint16(buf, rptr + 4);
+    port->secondName = serializers_readUint16(buf, rptr + 6);
+    if(port->node >= nNodes) return false;
+    if(port->name != TRAVERSAL_NO_NAME && port->name >= nameLen) return false;
+    if(port->secondName != TRAVERSAL_NO_NAME && port->secondName >= nameLen) return false;
+    rptr += TRAVERSAL_SNAPSHOT_PORT_LEN;
+  }
+  // gateways, 
+  for(uint16_t g = 0; g < nGateways; g ++){
+    TraversalGateway* gateway = &(foundGateways[g]);
+    gateway->node = buf[rptr];
+    gateway->kind = buf[rptr + 1];
+    gateway->typeKey = buf[rptr + 2];
+    gateway->open = buf[rptr + 3];
+    gateway->index = serializers_readUint16(buf, rptr + 4);
+    gateway->mtu = serializers_readUint16(buf, rptr + 6);
+    gateway->address = serializers_readUint16(buf, rptr + 8);
+    if(gateway->node >= nNodes) return false;
+    rptr += TRAVERSAL_SNAPSHOT_GATEWAY_LEN;
+  }
+  // names, which should be terminated, 
+  rptr += routePoolLen;
+  if(nameLen > 0 && src[rptr + nameLen - 1] != 0) return false;
+  memcpy(namePool, &(src[rptr]), nameLen);
+  // all clear, 
+  nodeCount = nNodes;
+  foundPortCount = nPorts;
+  foundGatewayCount = nGateways;
+  namePoolLen = nameLen;
+  inFlight = 0;
+  newTraverseID();
+  return true;
+}
+
+// ---------------------------------------------- Requests 
+
+void OSAP_Traversal::request(uint8_t node){
+  VPacket* pck = getPacketFromStack(this);
+  if(pck == nullptr) return;
+  // | TKEY_DISCOVER_REQ | ID | TRAVERSEID:4 | SECTION | CURSOR:2 |, 
+  // we use the node's index as the msg ID 
+  uint16_t wptr = 0;
+  reqBuffer[wptr ++] = TKEY_DISCOVER_REQ;
+  reqBuffer[wptr ++] = node;
+  traverseID[3] = node;
+  memcpy(&(reqBuffer[wptr]), traverseID, 4);
+  wptr += 4;
+  reqBuffer[wptr ++] = nodes[node].section;
+  serializers_writeUint16(reqBuffer, &wptr, nodes[node].cursor);
+  // route it, 
+  Route route;
+  getNodeRoute(node, &route);
+  route.end(OSAP_CONFIG_TRAVERSAL_TIMEOUT_MS);
+  stuffPacketRaw(pck, &route, reqBuffer, wptr);
+  nodes[node].state = TRAVERSAL_NODE_AWAITING;
+  nodes[node].sentAt = millis();
+  inFlight ++;
+}
+
+void OSAP_Traversal::verify(uint8_t node){
+  VPacket* pck = getPacketFromStack(this);
+  if(pck == nullptr) return;
+  // | TKEY_RUNTIMEINFO_REQ | ID | TRAVERSEID:4 |, which is enough to get an epoch 
+  reqBuffer[0] = TKEY_RUNTIMEINFO_REQ;
+  reqBuffer[1] = node;
+  traverseID[3] = node;
+  memcpy(&(reqBuffer[2]), traverseID, 4);
+  Route route;
+  getNodeRoute(node, &route);
+  route.end(OSAP_CONFIG_TRAVERSAL_TIMEOUT_MS);
+  stuffPacketRaw(pck, &route, reqBuffer, 6);
+  nodes[node].state = TRAVERSAL_NODE_VERIFYING;
+  nodes[node].sentAt = millis();
+  inFlight ++;
+}
+
+void OSAP_Traversal::loop(void){
+  if(nodeCount == 0) return;
+  uint32_t now = millis();
+  for(uint8_t n = 0; n < nodeCount; n ++){
+    TraversalNode* node = &(nodes[n]);
+    // time-outs, retry or give up 
+    if((node->state == TRAVERSAL_NODE_AWAITING || node->state == TRAVERSAL_NODE_VERIFYING) && 
+        now - node->sentAt > OSAP_CONFIG_TRAVERSAL_TIMEOUT_MS){
+      inFlight --;
+      if(node->retries ++ < OSAP_CONFIG_TRAVERSAL_RETRIES){
+        node->state = (node->state == TRAVERSAL_NODE_AWAITING) ? TRAVERSAL_NODE_QUEUED : TRAVERSAL_NODE_STALE;
+      } else {
+        node->state = TRAVERSAL_NODE_FAILED;
+      }
+    }
+    // issue what we can, 
+    if(inFlight >= OSAP_CONFIG_TRAVERSAL_MAX_IN_FLIGHT || !clearToSend()) continue;
+    if(node->state == TRAVERSAL_NODE_QUEUED){
+      request(n);
+    } else if (node->state == TRAVERSAL_NODE_STALE){
+      verify(n);
+    }
+  }
+}
+
+// ---------------------------------------------- Responses 
+
+void OSAP_Traversal::onVerify(VPacket* pck){
+  size_t rptr = pck->data[0] + 1;
+  uint8_t n = pck->data[rptr ++];
+  if(n >= nodeCount || nodes[n].state != TRAVERSAL_NODE_VERIFYING) return;
+  if(rptr + OSAP_RUNTIMEINFO_LEN > pck->len) return;
+  inFlight --;
+  // the device's epoch is in the info at 19, and its signature at 23, 
+  if(serializers_readUint32(pck->data, rptr + 19) == nodes[n].epoch && 
+     serializers_readUint32(pck->data, rptr + 23) == nodes[n].signature){
+    nodes[n].state = TRAVERSAL_NODE_DONE;
+  } else {
+    nodes[n].state = TRAVERSAL_NODE_CHANGED;
+  }
+}
+
+void OSAP_Traversal::onResponse(VPacket* pck){
+  if(pck->data[pck->data[0]] == TKEY_RUNTIMEINFO_RES){
+    onVerify(pck);
+    return;
+  }
+  size_t rptr = pck->data[0] + 1;
+  if(rptr + 2 > pck->len) return;
+  uint8_t n = pck->data[rptr ++];
+  if(n >= nodeCount || nodes[n].state != TRAVERSAL_NODE_AWAITING) return;
+  TraversalNode* node = &(nodes[n]);
+  // the page should pick up where we asked it to (or past it, if items were skipped): 
+  // a late reply to an earlier request (for another page) is ignored, and this one's timeout stands 
+  uint8_t firstSection = pck->data[rptr];
+  if(firstSection < DISCOVERKEY_CONTINUE){
+    if(rptr + 5 > pck->len) return;
+    uint16_t firstStart = serializers_readUint16(pck->data, rptr + 1);
+    uint8_t askedSection = (node->section < DISCOVERKEY_RUNTIME) ? DISCOVERKEY_RUNTIME : node->section;
+    if(firstSection < askedSection) return;
+    if(firstSection == askedSection && firstStart < node->cursor) return;
+  }
+  inFlight --;
+  // walk chunks, 
+  while(rptr < pck->len){
+    uint8_t section = pck->data[rptr ++];
+    if(section == DISCOVERKEY_END){
+      node->state = TRAVERSAL_NODE_DONE;
+      return;
+    } else if (section == DISCOVERKEY_CONTINUE){
+      if(rptr + 3 > pck->len) break;
+      node->section = pck->data[rptr ++];
+      node->cursor = serializers_readUint16(pck->data, rptr);
+      node->state = TRAVERSAL_NODE_QUEUED;
+      node->retries = 0;
+      return;
+    }
+    if(rptr + 4 > pck->len) break;
+    uint16_t start = serializers_readUint16(pck->data, rptr);
+    uint16_t count = serializers_readUint16(pck->data, rptr + 2);
+    rptr += 4;
+    for(uint16_t i = start; i < start + count; i ++){
+      switch(section){
+        case DISCOVERKEY_RUNTIME:
+          {
+            if(rptr + OSAP_RUNTIMEINFO_LEN > pck->len){ rptr = pck->len + 1; break; }
+            uint8_t* info = &(pck->data[rptr]);
+            // if this runtime was last-scoped by us, for another node, we've found a loop: 
+            // if it was for this one, that was an earlier try (or page) of this request 
+            if(memcmp(info, traverseID, 3) == 0 && info[3] != n){
+              node->state = TRAVERSAL_NODE_DUPLICATE;
+              return;
+            }
+            // track where we entered: newer runtimes report the instruction they arrived on, 
+            // older ones report the route's first, which is only theirs when they're one hop out 
+            if(node->depth == 1 || info[5] > 0 || info[6] >= OSAP_VERSION_LAST_ENTRY_MID){
+              if(info[8] == TKEY_LINKF) node->entryLink = serializers_readUint16(info, 9);
+              if(info[8] == TKEY_LINKF_S) node->entryLink = info[9];
+            }
+            node->shortKeys = (info[5] > 0 || info[6] >= OSAP_VERSION_SHORT_KEYS_MID);
+            node->linkMTUs = (info[5] > 0 || info[6] >= OSAP_VERSION_LINK_MTU_MID);
+            node->epoch = serializers_readUint32(info, 19);
+            node->signature = serializers_readUint32(info, 23);
+            rptr += OSAP_RUNTIMEINFO_LEN;
+          }
+          break;
+        case DISCOVERKEY_PORTS:
+          {
+            if(rptr + 2 > pck->len){ rptr = pck->len + 1; break; }
+            uint8_t type = pck->data[rptr ++];
+            uint8_t nNames = pck->data[rptr ++];
+            // stash anything w/ a name, 
+            TraversalPort* port = nullptr;
+            if(nNames > 0 && foundPortCount < OSAP_CONFIG_TRAVERSAL_MAX_PORTS){
+              port = &(foundPorts[foundPortCount ++]);
+              *port = TraversalPort();
+              port->node = n;
+              port->typeKey = type;
+              port->index = i;
+            }
+            for(uint8_t s = 0; s < nNames; s ++){
+              const char* name = (const char*)(&(pck->data[rptr]));
+              // names have to end inside the packet, 
+              size_t nameLen = strnlen(name, pck->len - rptr);
+              if(rptr + nameLen >= pck->len){
+                rptr = pck->len + 1;
+                break;
+              }
+              if(port != nullptr && s == 0) port->name = poolString(name);
+              if(port != nullptr && s == 1) port->secondName = poolString(name);
+              rptr += nameLen + 1;
+            }
+          }
+          break;
+        case DISCOVERKEY_LGATEWAYS:
+          {
+            uint8_t itemLen = node->linkMTUs ? 4 : 2;
+            if(rptr + itemLen > pck->len){ rptr = pck->len + 1; break; }
+            uint8_t open = pck->data[rptr + 1];
+            TraversalGateway* gateway = addGateway(n, TRAVERSAL_GATEWAY_LINK, i);
+            if(gateway != nullptr){
+              gateway->typeKey = pck->data[rptr];
+              gateway->open = open;
+              if(node->linkMTUs) gateway->mtu = serializers_readUint16(pck->data, rptr + 2);
+            }
+            rptr += itemLen;
+            // expand along open links, but not back the way we came, 
+            if(!open || i == node->entryLink) break;
+            if(node->depth + 1 >= OSAP_CONFIG_TRAVERSAL_MAX_DEPTH) break;
+            if(nodeCount >= OSAP_CONFIG_TRAVERSAL_MAX_NODES) break;
+            TraversalNode* child = &(nodes[nodeCount ++]);
+            *child = TraversalNode();
+            child->parent = n;
+            child->exitLink = i;
+            child->depth = node->depth + 1;
+            // re-collect our node, 
+            node = &(nodes[n]);
+          }
+          break;
+        case DISCOVERKEY_BGATEWAYS:
+          {
+            // | TYPE | ADDRESS:2 |, busses are recorded but aren't walked yet, 
+            if(rptr + 3 > pck->len){ rptr = pck->len + 1; break; }
+            TraversalGateway* gateway = addGateway(n, TRAVERSAL_GATEWAY_BUS, i);
+            if(gateway != nullptr){
+              gateway->typeKey = pck->data[rptr];
+              gateway->address = serializers_readUint16(pck->data, rptr + 1);
+            }
+            rptr += 3;
+          }
+          break;
+        default:
+          // bad chunk, we can't parse past it 
+          node->state = TRAVERSAL_NODE_FAILED;
+          return;
+      }
+      // items that run past the end are as bad, 
+      if(rptr > pck->len){
+        node->state = TRAVERSAL_NODE_FAILED;
+        return;
+      }
+    }
+  }
+  // fell off the end w/o a tail, 
+  node->state = TRAVERSAL_NODE_FAILED;
+}
@@ -0,0 +1,158 @@
+/*
+runtime/traversal.h
+
+embedded-side graph traversal: breadth-first discovery of every runtime 
+reachable over links, w/ routes to every named port 
+
+Jake Read at the Center for Bits and Atoms
+(c) Massachusetts Institute of Technology 2022
+
+This work may be reproduced, modified, distributed, performed, and
+displayed for any purpose, but must acknowledge the osap project.
+Copyright is retained and must be preserved. The work is provided as is;
+no warranty is provided, and users accept all liability.
+*/
+
+#ifndef OSAP_TRAVERSAL_H_
+#define OSAP_TRAVERSAL_H_
+
+#include "../structure/ports.h"
+
+// node states, 
+#define TRAVERSAL_NODE_QUEUED 0 
+#define TRAVERSAL_NODE_AWAITING 1 
+#define TRAVERSAL_NODE_DONE 2 
+#define TRAVERSAL_NODE_DUPLICATE 3 
+#define TRAVERSAL_NODE_FAILED 4 
+// loaded from a snapshot, not yet checked against the live device, 
+#define TRAVERSAL_NODE_STALE 5 
+// checking, 
+#define TRAVERSAL_NODE_VERIFYING 6 
+// checked, and the device's epoch (or signature) has moved on since the snapshot, 
+#define TRAVERSAL_NODE_CHANGED 7 
+
+#define TRAVERSAL_NO_PARENT 255 
+#define TRAVERSAL_NO_NAME 0xFFFF 
+
+// we keep runtimes as (parent, exit-link) pairs, so a node's route is 
+// its parent's route plus one linkf, and costs a few bytes rather than a whole Route 
+typedef struct TraversalNode {
+  uint8_t parent = TRAVERSAL_NO_PARENT;
+  uint8_t exitLink = 0;
+  uint8_t depth = 0;
+  uint8_t state = TRAVERSAL_NODE_QUEUED;
+  uint8_t retries = 0;
+  // where we left off in discovery pages, 
+  uint8_t section = 0;
+  uint16_t cursor = 0;
+  // which link we came in on, on the far side, so we don't expand back along it 
+  uint16_t entryLink = 0xFFFF;
+  uint32_t epoch = 0;
+  uint32_t signature = 0;
+  uint32_t sentAt = 0;
+  // new enough to read short (v2) route keys, 
+  boolean shortKeys = false;
+  // and to report link MTUs in discovery, 
+  boolean linkMTUs = false;
+} TraversalNode;
+
+// and named ports, w/ names in a shared pool 
+typedef struct TraversalPort {
+  uint8_t node;
+  uint8_t typeKey;
+  uint16_t index;
+  uint16_t name = TRAVERSAL_NO_NAME;
+  uint16_t secondName = TRAVERSAL_NO_NAME;
+} TraversalPort;
+
+// and every runtime's links and busses, 
+#define TRAVERSAL_GATEWAY_LINK 0 
+#define TRAVERSAL_GATEWAY_BUS 1 
+
+typedef struct TraversalGateway {
+  uint8_t node;
+  uint8_t kind = TRAVERSAL_GATEWAY_LINK;
+  uint8_t typeKey;
+  uint8_t open = 0;
+  uint16_t index;
+  // links' MTUs, (0 from runtimes too old to report them) and busses' addresses 
+  uint16_t mtu = 0;
+  uint16_t address = 0;
+} TraversalGateway;
+
+// snapshots are flat, little-endian, and fixed-stride so they can be read in-place 
+// (from flash, or a mmap'd file on the host side), laid out as: 
+// | MAGIC:4 | VERSION | NODECOUNT | PORTCOUNT:2 | GATEWAYCOUNT:2 | ROUTEPOOLLEN:2 | NAMEPOOLLEN:2 | TOTALLEN:4 | 
+// | NODE * NODECOUNT | PORT * PORTCOUNT | GATEWAY * GATEWAYCOUNT | ROUTEPOOL | NAMEPOOL | 
+// NODE: | PARENT | EXITLINK | DEPTH | STATE | ENTRYLINK:2 | ROUTEOFFSET:2 | ROUTELEN | SHORTKEYS | LINKMTUS | RESERVED | EPOCH:4 | SIGNATURE:4 | 
+// PORT: | NODE | TYPEKEY | INDEX:2 | NAME:2 | SECONDNAME:2 | (names are offsets into the namepool) 
+// GATEWAY: | NODE | KIND | TYPEKEY | OPEN | INDEX:2 | MTU:2 | ADDRESS:2 | 
+// routes are Route::encodedPath bytes, so a reader can use them w/o walking parents 
+#define TRAVERSAL_SNAPSHOT_MAGIC 0x5347534F // "OSGS" 
+#define TRAVERSAL_SNAPSHOT_VERSION 3 
+#define TRAVERSAL_SNAPSHOT_HEADER_LEN 18 
+#define TRAVERSAL_SNAPSHOT_NODE_LEN 20 
+#define TRAVERSAL_SNAPSHOT_PORT_LEN 8 
+#define TRAVERSAL_SNAPSHOT_GATEWAY_LEN 10 
+
+class OSAP_Traversal : public VPort {
+  public:
+    // -------------------------------- Constructors 
+    OSAP_Traversal(void);
+
+    // -------------------------------- User API 
+    // (re)start a traversal from this runtime, 
+    void start(void);
+    // true once every reachable runtime has replied or failed, 
+    boolean isDone(void);
+    // find a port by name (or device unique-name), writing a route to it, 
+    // returns false if we haven't found one 
+    boolean findPort(const char* name, Route* route, uint16_t* portIndex);
+    // write the route to a node, in short (v2) form if every runtime along it reads that, 
+    void getNodeRoute(uint8_t node, Route* route);
+
+    // -------------------------------- Snapshots 
+    // write the table out, returns the snapshot's length, or 0 if it won't fit in maxLen 
+    size_t writeSnapshot(uint8_t* dest, size_t maxLen);
+    // load a table, returns false if the snapshot is malformed (which may leave the table empty): 
+    // loaded nodes are usable right away, and are checked against live devices in the background 
+    boolean loadSnapshot(const uint8_t* src, size_t len);
+    // true once every loaded node has been checked, 
+    boolean isVerified(void);
+    // true if any device has changed since the snapshot, in which case start() again 
+    boolean isChanged(void);
+
+    // the table, 
+    TraversalNode nodes[OSAP_CONFIG_TRAVERSAL_MAX_NODES];
+    uint8_t nodeCount = 0;
+    TraversalPort foundPorts[OSAP_CONFIG_TRAVERSAL_MAX_PORTS];
+    uint16_t foundPortCount = 0;
+    TraversalGateway foundGateways[OSAP_CONFIG_TRAVERSAL_MAX_GATEWAYS];
+    uint16_t foundGatewayCount = 0;
+    const char* getPoolName(uint16_t offset);
+
+    // -------------------------------- Runtime-Facing API 
+    // the runtime calls this once per loop, 
+    void loop(void);
+    // and hands us TKEY_DISCOVER_RES and TKEY_RUNTIMEINFO_RES packets, 
+    void onResponse(VPacket* pck);
+    // we don't take port-to-port messages, 
+    void onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) override;
+
+  private:
+    void request(uint8_t node);
+    void verify(uint8_t node);
+    void onVerify(VPacket* pck);
+    void newTraverseID(void);
+    uint16_t poolString(const char* str);
+    TraversalGateway* addGateway(uint8_t node, uint8_t kind, uint16_t index);
+    // the traversal's ID is three bytes, each request carries it w/ the node's index as the 
+    // fourth: the handoff then tells us who scoped a runtime last, so a retry isn't a loop 
+    uint8_t traverseID[4];
+    uint8_t inFlight = 0;
+    char namePool[OSAP_CONFIG_TRAVERSAL_NAME_POOL];
+    uint16_t namePoolLen = 0;
+    uint8_t reqBuffer[16];
+};
+
+#endif 
@@ -0,0 +1,253 @@
+// time-slotted bus arbitration 
+
+#include "bus_tdma.h"
+#include "../packets/packets.h"
+#include "../utils/serializers.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+
+BGateway_TDMA::BGateway_TDMA(OSAP_Runtime* _runtime, uint16_t _address, boolean _isHead) : 
+  BGateway(_runtime, _address)
+{
+  isHead = _isHead;
+}
+
+void BGateway_TDMA::setSlotWidth(uint16_t micros){
+  slotWidthUs = micros;
+}
+
+void BGateway_TDMA::begin(void){
+  phyBegin();
+  if(isHead){
+    // we own slot 0, always, 
+    owners[0] = address;
+    missed[0] = 0;
+    nSlots = 1;
+    mySlot = 0;
+    synced = true;
+    startCycle();
+  }
+}
+
+// ---------------------------------------------- Cycle / Slot Management 
+
+void BGateway_TDMA::startCycle(void){
+  uint32_t now = micros();
+  // track cycle lengths, for worst-case latency, 
+  if(cycle > 0){
+    lastCycleMicros = now - cycleStart;
+    if(lastCycleMicros > maxCycleMicros) maxCycleMicros = lastCycleMicros;
+  }
+  cycleStart = now;
+  cycle ++;
+  // reclaim silent slots, compacting the table (slot 0 is ours), 
+  uint8_t keep = 1;
+  for(uint8_t s = 1; s < nSlots; s ++){
+    if(missed[s] < OSAP_BUSCONFIG_TDMA_RECLAIM_CYCLES){
+      owners[keep] = owners[s];
+      missed[keep] = missed[s];
+      keep ++;
+    }
+  }
+  nSlots = keep;
+  // and the sync goes out when the wire is clear, 
+  syncPending = true;
+}
+
+void BGateway_TDMA::transmitSync(void){
+  uint8_t frame[TDMA_SYNC_HEADER_SIZE + OSAP_BUSCONFIG_TDMA_MAX_SLOTS];
+  uint16_t wptr = 0;
+  frame[wptr ++] = TDMA_FRAME_SYNC;
+  frame[wptr ++] = address;
+  serializers_writeUint16(frame, &wptr, cycle);
+  serializers_writeUint16(frame, &wptr, slotWidthUs);
+  frame[wptr ++] = nSlots;
+  for(uint8_t s = 0; s < nSlots; s ++){
+    frame[wptr ++] = owners[s];
+  }
+  phyTransmit(frame, wptr);
+  syncPending = false;
+  // and we're in slot 0, 
+  currentSlot = 0;
+  slotStart = micros();
+  transmittedThisSlot = false;
+}
+
+void BGateway_TDMA::advanceSlot(void){
+  currentSlot ++;
+  slotStart = micros();
+  transmittedThisSlot = false;
+  // past the contention slot: the head starts over, drops wait for the next sync 
+  if(currentSlot > nSlots){
+    if(isHead){
+      startCycle();
+    } else {
+      synced = false;
+    }
+  }
+}
+
+void BGateway_TDMA::transmitInSlot(void){
+  if(txLen > 0){
+    phyTransmit(txFrame, txLen);
+    txLen = 0;
+  } else {
+    // nothing to say, but we say so to end the slot early and to show we're alive 
+    uint8_t idle[TDMA_HEADER_SIZE] = { TDMA_FRAME_IDLE, (uint8_t)address };
+    phyTransmit(idle, TDMA_HEADER_SIZE);
+  }
+  transmittedThisSlot = true;
+  advanceSlot();
+}
+
+// ---------------------------------------------- Loop 
+
+void BGateway_TDMA::loop(void){
+  phyLoop();
+  // hand off whatever we heard, once there's stack space for it, 
+  if(rxLen > 0 && getPacketCheck(this)){
+    VPacket* pck = getPacketFromStack(this);
+    memcpy(pck->data, rxPacket, rxLen);
+    pck->len = rxLen;
+    rxLen = 0;
+    ingestPacket(pck, rxSource);
+  }
+  if(!synced) return;
+  // heads open each cycle w/ a sync, 
+  if(syncPending){
+    if(phyClearToTransmit()) transmitSync();
+    return;
+  }
+  // slot timers only run while the wire is quiet: a frame in flight holds its slot open 
+  if(!phyClearToTransmit()) slotStart = micros();
+  // our turn ? 
+  if(currentSlot == mySlot && !transmittedThisSlot){
+    if(phyClearToTransmit()) transmitInSlot();
+    return;
+  }
+  // the contention slot, for un-slotted drops, 
+  if(currentSlot == nSlots && mySlot < 0 && !transmittedThisSlot){
+    // skip some cycles (by address), so that simultaneous joiners don't always collide 
+    if(((cycle + address) % 3) == 0 && phyClearToTransmit()){
+      uint8_t join[TDMA_HEADER_SIZE] = { TDMA_FRAME_JOIN, (uint8_t)address };
+      phyTransmit(join, TDMA_HEADER_SIZE);
+    }
+    transmittedThisSlot = true;
+  }
+  // silent owners time out, 
+  if(micros() - slotStart > slotWidthUs){
+    if(isHead && currentSlot > 0 && currentSlot < nSlots){
+      if(missed[currentSlot] < 255) missed[currentSlot] ++;
+    }
+    advanceSlot();
+  }
+}
+
+// ---------------------------------------------- Reception 
+
+void BGateway_TDMA::onPhyFrame(uint8_t* frame, size_t len){
+  // runts, and frames larger than a packet (+ our header) can't be ours, 
+  if(len < TDMA_HEADER_SIZE || len - TDMA_HEADER_SIZE > OSAP_CONFIG_PACKET_MAX_SIZE) return;
+  uint8_t src = frame[1];
+  switch(frame[0]){
+    case TDMA_FRAME_SYNC:
+      {
+        // heads don't listen to other heads, 
+        if(isHead) return;
+        // | SYNC | SRC | CYCLE:2 | SLOTWIDTH:2 | NSLOTS | OWNERS:NSLOTS | 
+        if(len < 7) return;
+        uint8_t n = frame[6];
+        if(n > OSAP_BUSCONFIG_TDMA_MAX_SLOTS) n = OSAP_BUSCONFIG_TDMA_MAX_SLOTS;
+        if(len < 7 + (size_t)n) return;
+        cycle = serializers_readUint16(frame, 2);
+        slotWidthUs = serializers_readUint16(frame, 4);
+        nSlots = n;
+        mySlot = -1;
+        for(uint8_t s = 0; s < nSlots; s ++){
+          owners[s] = frame[7 + s];
+          if(owners[s] == address) mySlot = s;
+        }
+        currentSlot = 0;
+        slotStart = micros();
+        transmittedThisSlot = false;
+        synced = true;
+      }
+      break;
+    case TDMA_FRAME_DATA:
+    case TDMA_FRAME_IDLE:
+      {
+        // stash data, this is what the runtime sees: we have one rx buffer, so 
+        // frames for other drops (or channels we don't listen to) mustn't take it, 
+        if(frame[0] == TDMA_FRAME_DATA && isForUs(&(frame[TDMA_HEADER_SIZE]), len - TDMA_HEADER_SIZE)){
+          if(rxLen > 0){
+            rxOverruns ++;
+          } else {
+            rxLen = len - TDMA_HEADER_SIZE;
+            rxSource = src;
+            memcpy(rxPacket, &(frame[TDMA_HEADER_SIZE]), rxLen);
+          }
+        }
+        // and the owner's frame ends their slot: find it, so that we re-align 
+        // if we've missed something 
+        for(uint8_t s = 0; s < nSlots; s ++){
+          if(owners[s] == src){
+            if(isHead) missed[s] = 0;
+            currentSlot = s;
+            advanceSlot();
+            break;
+          }
+        }
+      }
+      break;
+    case TDMA_FRAME_JOIN:
+      {
+        if(!isHead) return;
+        // assign a slot, if it's new and we have space, 
+        boolean exists = false;
+        for(uint8_t s = 0; s < nSlots; s ++){
+          if(owners[s] == src) exists = true;
+        }
+        if(!exists && nSlots < OSAP_BUSCONFIG_TDMA_MAX_SLOTS){
+          owners[nSlots] = src;
+          missed[nSlots] = 0;
+          nSlots ++;
+        }
+        // and the contention slot is over, start again w/ the new table 
+        startCycle();
+      }
+      break;
+  }
+}
+
+// ---------------------------------------------- BGateway API 
+
+boolean BGateway_TDMA::clearToSend(uint16_t address){
+  return (txLen == 0 && mySlot >= 0);
+}
+
+boolean BGateway_TDMA::isOpen(uint16_t _address){
+  for(uint8_t s = 0; s < nSlots; s ++){
+    if(owners[s] == _address) return true;
+  }
+  return false;
+}
+
+void BGateway_TDMA::send(uint16_t _address, uint8_t* data, size_t len){
+  // the destination is in the packet's instruction, receivers filter on it, 
+  // so we just queue it for our next slot 
+  if(len > OSAP_CONFIG_PACKET_MAX_SIZE) return;
+  txFrame[0] = TDMA_FRAME_DATA;
+  txFrame[1] = address;
+  memcpy(&(txFrame[TDMA_HEADER_SIZE]), data, len);
+  txLen = len + TDMA_HEADER_SIZE;
+}
+
+boolean BGateway_TDMA::clearToBroadcast(uint16_t channel){
+  return clearToSend(0);
+}
+
+void BGateway_TDMA::broadcast(uint16_t channel, uint8_t* data, size_t len){
+  send(0, data, len);
+}
+
+#endif 
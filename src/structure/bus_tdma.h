@@ -0,0 +1,110 @@
+// time-slotted bus arbitration 
+
+#ifndef BUS_TDMA_H_
+#define BUS_TDMA_H_
+
+#include "busses.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+
+// a bus gateway that arbitrates a shared wire w/ time slots: 
+// the head drop transmits a SYNC carrying the slot table, then each drop transmits 
+// exactly one frame (data, or an IDLE if it has nothing) in its own slot, in order. 
+// slots end as soon as their owner's frame is heard, or after slotWidth if the owner 
+// is silent, so idle drops cost one short IDLE frame rather than a whole slot. 
+// a frame that is still on the wire holds its slot open, so a slot lasts at most 
+// slotWidth + the airtime of the largest frame (a whole packet plus TDMA_HEADER_SIZE), 
+// and a cycle (thus the longest a drop waits for its turn) is at most 
+// airtime(SYNC) + (nSlots + 1) * (slotWidth + airtime(OSAP_CONFIG_PACKET_MAX_SIZE + TDMA_HEADER_SIZE)) 
+// plus loop latency, see TDMA_CYCLE_BOUND_US. after the last slot there is one 
+// contention slot where un-slotted drops can JOIN, and the head reclaims slots whose 
+// owners stay silent for OSAP_BUSCONFIG_TDMA_RECLAIM_CYCLES cycles. 
+// TDMA addresses are 0-254, and the head is always in slot 0 
+
+// frame keys, each frame is | KEY | SRC | ... | 
+#define TDMA_FRAME_SYNC 1   // | SYNC | SRC | CYCLE:2 | SLOTWIDTH_US:2 | NSLOTS | OWNER * NSLOTS | 
+#define TDMA_FRAME_DATA 2   // | DATA | SRC | PACKET | 
+#define TDMA_FRAME_IDLE 3   // | IDLE | SRC | 
+#define TDMA_FRAME_JOIN 4   // | JOIN | SRC | 
+
+#define TDMA_HEADER_SIZE 2 
+// | SYNC | SRC | CYCLE:2 | SLOTWIDTH_US:2 | NSLOTS |, before the table 
+#define TDMA_SYNC_HEADER_SIZE 7 
+
+// the worst-case cycle above, in microseconds, for a wire that takes 10 bits per byte 
+// (as a UART does) at bitRate, w/ nSlots drops slotted in, 
+#define TDMA_AIRTIME_US(bytes, bitRate) (((uint64_t)(bytes) * 10 * 1000000UL) / (bitRate)) 
+#define TDMA_CYCLE_BOUND_US(nSlots, slotWidthUs, bitRate) ( \
+  TDMA_AIRTIME_US(TDMA_SYNC_HEADER_SIZE + (nSlots), bitRate) + \
+  ((uint64_t)(nSlots) + 1) * ((slotWidthUs) + TDMA_AIRTIME_US(OSAP_CONFIG_PACKET_MAX_SIZE + TDMA_HEADER_SIZE, bitRate)) )
+
+class BGateway_TDMA : public BGateway {
+  public:
+    // -------------------------------- PHY-Implementers Author these Funcs
+    // startup the wire, 
+    virtual void phyBegin(void) = 0;
+    // operate the wire, calling onPhyFrame() for each frame heard, 
+    virtual void phyLoop(void) = 0;
+    // whether / not we can put a frame on the wire right now, 
+    virtual boolean phyClearToTransmit(void) = 0;
+    // put a frame on the wire, 
+    virtual void phyTransmit(uint8_t* frame, size_t len) = 0;
+
+    // -------------------------------- PHY-Implementers use these funcs 
+    void onPhyFrame(uint8_t* frame, size_t len);
+
+    // -------------------------------- Head Config 
+    // the head sets slot width, drops adopt it from each SYNC 
+    void setSlotWidth(uint16_t micros);
+
+    // -------------------------------- BGateway API 
+    void begin(void) override;
+    void loop(void) override;
+    boolean clearToSend(uint16_t address) override;
+    boolean isOpen(uint16_t address) override;
+    void send(uint16_t address, uint8_t* data, size_t len) override;
+    boolean clearToBroadcast(uint16_t channel) override;
+    void broadcast(uint16_t channel, uint8_t* data, size_t len) override;
+
+    // -------------------------------- Constructors 
+    BGateway_TDMA(OSAP_Runtime* _runtime, uint16_t _address, boolean _isHead);
+
+    // -------------------------------- States, public for stats / benchmarks 
+    uint16_t cycle = 0;
+    uint32_t rxOverruns = 0;
+    uint32_t lastCycleMicros = 0;
+    uint32_t maxCycleMicros = 0;
+
+  private:
+    void advanceSlot(void);
+    void startCycle(void);
+    void transmitSync(void);
+    void transmitInSlot(void);
+
+    boolean isHead = false;
+    boolean synced = false;
+    // the slot table, 
+    uint16_t slotWidthUs = OSAP_BUSCONFIG_TDMA_SLOT_WIDTH_US;
+    uint8_t owners[OSAP_BUSCONFIG_TDMA_MAX_SLOTS];
+    uint8_t nSlots = 0;
+    // where we are in the cycle: nSlots is the contention (join) slot 
+    uint8_t currentSlot = 0;
+    uint32_t slotStart = 0;
+    uint32_t cycleStart = 0;
+    int16_t mySlot = -1;
+    boolean transmittedThisSlot = false;
+    // head-only: sync is written when the wire is next clear, 
+    boolean syncPending = false;
+    // head-only: consecutive silent cycles per slot, 
+    uint8_t missed[OSAP_BUSCONFIG_TDMA_MAX_SLOTS];
+    // one frame each way, 
+    uint8_t txFrame[OSAP_CONFIG_PACKET_MAX_SIZE + TDMA_HEADER_SIZE];
+    size_t txLen = 0;
+    uint8_t rxPacket[OSAP_CONFIG_PACKET_MAX_SIZE];
+    size_t rxLen = 0;
+    uint16_t rxSource = 0;
+};
+
+#endif 
+
+#endif 
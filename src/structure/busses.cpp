@@ -0,0 +1,84 @@
+// busses ! 
+
+#include "busses.h"
+#include "../packets/packets.h"
+#include "../utils/serializers.h"
+#include "../utils/trace.h"
+#include "../utils/log.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+
+BGateway::BGateway(OSAP_Runtime* _runtime, uint16_t _address){
+  // track our runtime and address, 
+  runtime = _runtime;
+  address = _address;
+
+  // don't over-insert: 
+  if(runtime->bgatewayCount >= OSAP_CONFIG_MAX_BGATEWAYS){
+    OSAP_LOG(LOGCODE_TOO_MANY_BGATEWAYS, 0);
+    return;
+  }
+
+  // collect our index and stash ourselves in the runtime, 
+  index = runtime->bgatewayCount;
+  runtime->bgateways[runtime->bgatewayCount ++] = this;
+  runtime->bumpEpoch();
+}
+
+void BGateway::subscribe(uint16_t channel){
+  if(channel >= OSAP_BUSCONFIG_MAX_BROADCAST_CHANNELS) return;
+  subscriptions[channel / 8] |= (1 << (channel % 8));
+}
+
+void BGateway::unsubscribe(uint16_t channel){
+  if(channel >= OSAP_BUSCONFIG_MAX_BROADCAST_CHANNELS) return;
+  subscriptions[channel / 8] &= ~(1 << (channel % 8));
+}
+
+boolean BGateway::isSubscribed(uint16_t channel){
+  if(channel >= OSAP_BUSCONFIG_MAX_BROADCAST_CHANNELS) return false;
+  return subscriptions[channel / 8] & (1 << (channel % 8));
+}
+
+boolean BGateway::isForUs(uint8_t* data, size_t len){
+  // the instruction we land on is the one the transmitter serviced, 
+  // | TKEY_BUSF | txIndex:2 | txAddress:2 | or | TKEY_BUSB | txIndex:2 | channel:2 | 
+  if(len < 1 || (size_t)data[0] + 5 > len){
+    OSAP_LOG(LOGCODE_INGEST_BAD_PTR, index);
+    return false;
+  }
+  uint8_t key = data[data[0]];
+  uint16_t target = serializers_readUint16(data, data[0] + 3);
+  if(key == TKEY_BUSF){
+    // shared mediums hear everything, so we filter here, 
+    return (target == address);
+  } else if (key == TKEY_BUSB){
+    return isSubscribed(target);
+  } else {
+    OSAP_LOG(LOGCODE_INGEST_BAD_PTR, index);
+    return false;
+  }
+}
+
+void BGateway::ingestPacket(VPacket* pck, uint16_t sourceAddress){
+  if(!isForUs(pck->data, pck->len)){
+    relinquishPacketToStack(pck);
+    return;
+  }
+  // count it, 
+  bytesIn += pck->len;
+  OSAP_TRACE(TRACE_EVT_INGEST, 1, index);
+  // and re-write the instruction for reversal: replies to broadcasts 
+  // go back to the one drop who sent it, so both cases become a BUSF
+  uint16_t wptr = pck->data[0];
+  pck->data[wptr ++] = TKEY_BUSF;
+  serializers_writeUint16(pck->data, &wptr, index);
+  serializers_writeUint16(pck->data, &wptr, sourceAddress);
+  // bump the pointer up, 
+  pck->data[0] += TKEY_BUSF_INC;
+  // and calculate a service deadline, 
+  uint16_t perHopTimeToLive = serializers_readUint16(pck->data, 1);
+  pck->serviceDeadline = millis() + perHopTimeToLive;
+}
+
+#endif 
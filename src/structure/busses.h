@@ -0,0 +1,83 @@
+// busses ! 
+
+#ifndef BUSSES_H_
+#define BUSSES_H_
+
+#include "../runtime/runtime.h"
+#include "../utils/keys.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_BUS_CODES
+
+// bus gateways are multi-drop links: each drop has an address on the bus, 
+// and frames are either addressed (TKEY_BUSF) to one drop or broadcast 
+// (TKEY_BUSB) on a channel, to every drop that has subscribed to it 
+
+class BGateway {
+  public:
+    // -------------------------------- Bus-Implementers Author these Funcs
+    // implement a .begin() to startup the bus, 
+    virtual void begin(void) = 0;
+
+    // implement a function that is called once per runtime, 
+    virtual void loop(void) = 0;
+
+    // implement a function that reports whether/not the bus 
+    // is ready to send new data to this address, 
+    virtual boolean clearToSend(uint16_t address) = 0;
+
+    // and whether/not the drop at this address is alive, 
+    virtual boolean isOpen(uint16_t address) = 0;
+
+    // implement a function that transmits this packet to one drop, 
+    virtual void send(uint16_t address, uint8_t* data, size_t len) = 0;
+
+    // and the broadcast equivalents, where one frame reaches every subscriber 
+    virtual boolean clearToBroadcast(uint16_t channel) = 0;
+    virtual void broadcast(uint16_t channel, uint8_t* data, size_t len) = 0;
+
+    // -------------------------------- Bus-Implementers use these funcs 
+
+    // having written off-the-line data into `pck` during loop, implementer 
+    // calls this w/ the bus address of the drop who transmitted it, 
+    // frames that aren't ours (wrong address, unsubscribed channel) are dropped here, 
+    // so implementers on a shared medium can hand us everything they hear 
+    void ingestPacket(VPacket* pck, uint16_t sourceAddress);
+    // the same check, on raw bytes: so that those w/ one rx buffer can filter 
+    // before they stash a frame, 
+    boolean isForUs(uint8_t* data, size_t len);
+
+    // pick which broadcast channels we listen to, 
+    void subscribe(uint16_t channel);
+    void unsubscribe(uint16_t channel);
+    boolean isSubscribed(uint16_t channel);
+
+    // -------------------------------- Constructors
+
+    BGateway(OSAP_Runtime* _runtime, uint16_t _address);
+
+    // -------------------------------- Properties 
+
+    uint8_t typeKey = BGATEWAYTYPEKEY_NULL;
+    // our own address on the bus, 
+    uint16_t address = 0;
+
+    // -------------------------------- States 
+    uint8_t currentPacketHold = 0;
+    uint8_t maxPacketHold = 2;
+    // most-ever held at once, and traffic totals, for stats 
+    uint8_t peakPacketHold = 0;
+    uint32_t bytesIn = 0;
+    uint32_t bytesOut = 0;
+
+  protected:
+    // subscriptions, one bit per channel 
+    uint8_t subscriptions[(OSAP_BUSCONFIG_MAX_BROADCAST_CHANNELS + 7) / 8] = { 0 };
+
+  private:
+    OSAP_Runtime* runtime;
+    uint16_t index; 
+};
+
+#endif 
+
+#endif 
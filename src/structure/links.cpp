@@ -4,35 +4,49 @@
 #include "../packets/packets.h"
 #include "../utils/serializers.h"
 
-#include "../utils/debug.h"
+#include "../utils/trace.h"
+#include "../utils/log.h"
 
 LGateway::LGateway(OSAP_Runtime* _runtime){
   // track our runtime, 
   runtime = _runtime;
 
   // don't over-insert: 
-  if(runtime->portCount >= OSAP_CONFIG_MAX_LGATEWAYS){
-    OSAP_ERROR("too many links instantiated...");
+  if(runtime->lgatewayCount >= OSAP_CONFIG_MAX_LGATEWAYS){
+    OSAP_LOG(LOGCODE_TOO_MANY_LGATEWAYS, 0);
     return;
   } 
   
   // collect our index and stash ourselves in the runtime, 
-  index = runtime->portCount;
+  index = runtime->lgatewayCount;
   runtime->lgateways[runtime->lgatewayCount ++] = this;
+  runtime->bumpEpoch();
 }
 
 void LGateway::ingestPacket(VPacket* pck){
   // this should be the case, badness if not
-  if(pck->data[pck->data[0]] != TKEY_LINKF){
-    OSAP_ERROR("bad PTR during packet ingest at link " + String(index));
+  uint8_t key = pck->data[pck->data[0]];
+  if(key != TKEY_LINKF && key != TKEY_LINKF_S && key != TKEY_LINKF_RI && key != TKEY_RIDF){
+    OSAP_LOG(LOGCODE_INGEST_BAD_PTR, index);
     relinquishPacketToStack(pck);
     return;
   }
-  // otherwise copy-in our index for rev-ersal, 
-  uint16_t wptr = pck->data[0] + 1;
-  serializers_writeUint16(pck->data, &wptr, index);
-  // bump the pointer up, 
-  pck->data[0] += TKEY_LINKF_INC;
+  // count it, 
+  bytesIn += pck->len;
+  OSAP_TRACE(TRACE_EVT_INGEST, 0, index);
+  if(key == TKEY_LINKF_S){
+    // short form, one byte, 
+    pck->data[pck->data[0] + 1] = index;
+    pck->data[0] += TKEY_LINKF_S_INC;
+  } else if(key == TKEY_RIDF){
+    // labels stay put, the runtime knows where they came in from pck->lgateway, 
+  } else {
+    // otherwise copy-in our index for rev-ersal, 
+    uint16_t wptr = pck->data[0] + 1;
+    serializers_writeUint16(pck->data, &wptr, index);
+    // bump the pointer up, 
+    pck->data[0] += (key == TKEY_LINKF) ? TKEY_LINKF_INC : TKEY_LINKF_RI_INC;
+  }
   // and calculate a service deadline, 
   uint16_t perHopTimeToLive = serializers_readUint16(pck->data, 1);
   pck->serviceDeadline = millis() + perHopTimeToLive;
@@ -26,12 +26,19 @@ class LGateway {
     // implement a function that transmits this packet, 
     virtual void send(uint8_t* data, size_t len) = 0;
 
+    // links that can carry (or have negotiated) larger frames override this, 
+    // the runtime won't hand us anything longer 
+    virtual uint16_t getMTU(void){ return OSAP_CONFIG_LINK_DEFAULT_MTU; }
+
     // -------------------------------- Link-Implementers use these funcs 
 
     // having written off-the-line data into `pck` during loop, 
     // implementer calls this 
     void ingestPacket(VPacket* pck);
 
+    // our place in the runtime's list, 
+    uint16_t getIndex(void){ return index; }
+
     // -------------------------------- Constructors
 
     LGateway(OSAP_Runtime* _runtime);
@@ -43,6 +50,10 @@ class LGateway {
     // -------------------------------- States 
     uint8_t currentPacketHold = 0;
     uint8_t maxPacketHold = 2;
+    // most-ever held at once, and traffic totals, for stats 
+    uint8_t peakPacketHold = 0;
+    uint32_t bytesIn = 0;
+    uint32_t bytesOut = 0;
 
     private:
       OSAP_Runtime* runtime;
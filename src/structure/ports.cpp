@@ -2,8 +2,9 @@
 
 #include "ports.h"
 #include "../packets/packets.h"
+#include "../packets/fragments.h"
 
-#include "../utils/debug.h"
+#include "../utils/log.h"
 
 // default constructor 
 VPort::VPort(OSAP_Runtime* _runtime){
@@ -12,13 +13,14 @@ VPort::VPort(OSAP_Runtime* _runtime){
 
   // don't over-insert: 
   if(runtime->portCount >= OSAP_CONFIG_MAX_PORTS){
-    OSAP_ERROR("too many ports instantiated...");
+    OSAP_LOG(LOGCODE_TOO_MANY_PORTS, 0);
     return;
   } 
   
   // collect our index and stash ourselves in the runtime, 
   index = runtime->portCount;
   runtime->ports[runtime->portCount ++] = this;
+  runtime->bumpEpoch();
 }
 
 uint8_t VPort::_payload[OSAP_CONFIG_PACKET_MAX_SIZE];
@@ -30,6 +32,19 @@ uint8_t VPort::_payload[OSAP_CONFIG_PACKET_MAX_SIZE];
 // default begin code...
 void VPort::begin(void){};
 
+// and we have none of our own, 
+void VPort::loop(void){};
+
+// and we are nameless, by default 
+const char* VPort::getName(uint8_t i){
+  return nullptr;
+}
+
+// and don't sample, 
+boolean VPort::sample(uint8_t* args, size_t argsLen, uint8_t* dest, size_t maxLen, size_t* len){
+  return false;
+}
+
 boolean VPort::clearToSend(void){
   return getPacketCheck(this);
 }
@@ -38,10 +53,21 @@ void VPort::send(uint8_t* data, size_t len, Route* route, uint16_t destinationPo
   // allocate & check, 
   VPacket* pck = getPacketFromStack(this);
   if(pck == nullptr) {
-    OSAP_ERROR("bad packet allocate on vport.send() at " + String(index));
+    OSAP_LOG(LOGCODE_PORT_ALLOCATE_FAIL, index);
     return;
   }
   // stuff it, 
   stuffPacketPortToPort(pck, route, index, destinationPort, data, len);
   // I think that's actually it ? 
-}
\ No newline at end of file
+}
+boolean VPort::sendLarge(uint8_t* data, size_t len, Route* route, uint16_t destinationPort){
+  return fragmentsSend(this, index, data, len, route, destinationPort);
+}
+
+boolean VPort::isSendingLarge(void){
+  return fragmentsSending(this);
+}
+
+boolean VPort::acceptLarge(uint8_t* buffer, size_t size){
+  return fragmentsAccept(this, buffer, size);
+}
@@ -16,10 +16,27 @@ class VPort {
     // sends data of len along the provided route, to another port
     // be sure to check if you are .clearToSend beforehand 
     void send(uint8_t* data, size_t len, Route* route, uint16_t destinationPort);
+    // sends a message larger than one segment, in pieces (see packets/fragments.h), 
+    // `data` has to stay put until .isSendingLarge() returns false, 
+    // returns false if we're already sending one, or it's too large 
+    boolean sendLarge(uint8_t* data, size_t len, Route* route, uint16_t destinationPort);
+    boolean isSendingLarge(void);
+    // and to receive them, a port needs a buffer: whole messages are handed to onPacket 
+    // from there, so the buffer is only valid during that call 
+    boolean acceptLarge(uint8_t* buffer, size_t size);
 
     // -------------------------------- Runtime-Facing API
     virtual void begin(void);
+    // called once per runtime loop, for ports w/ work of their own (i.e. flushing buffers) 
+    virtual void loop(void);
     virtual void onPacket(uint8_t* data, size_t len, Route* sourceRoute, uint16_t sourcePort) = 0;
+    // ports w/ names report them here (i.e. for TKEY_DISCOVER_REQ), 
+    // returning nullptr once `i` is past their last name 
+    virtual const char* getName(uint8_t i);
+    // ports that can be subscribed to (see runtime/subscriptions.h) produce one sample here, 
+    // from the subscription's args, into dest: returning false if they can't 
+    // (and a *len > maxLen if it didn't fit) 
+    virtual boolean sample(uint8_t* args, size_t argsLen, uint8_t* dest, size_t maxLen, size_t* len);
 
     // -------------------------------- Constructors
 
@@ -32,6 +49,8 @@ class VPort {
     // -------------------------------- States
     uint8_t currentPacketHold = 0;
     uint8_t maxPacketHold = 2;
+    // most-ever held at once, for stats 
+    uint8_t peakPacketHold = 0;
 
     // -------------------------------- stash-ute 
     static uint8_t _payload[OSAP_CONFIG_PACKET_MAX_SIZE];
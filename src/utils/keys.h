@@ -10,24 +10,70 @@
 // for transport
 #define TKEY_LINKF 12
 #define TKEY_BUSF 14 
+#define TKEY_BUSB 15 
 #define TKEY_PORTPACK 33 
 
+// short (v2) forms, for indices < 256: | TKEY_LINKF_S | index | and | TKEY_PORTPACK_S | src | dst |, 
+// only for routes where every runtime is >= OSAP_VERSION_SHORT_KEYS_MID (see Route::shorten()) 
+#define TKEY_LINKF_S 18 
+#define TKEY_PORTPACK_S 35 
+
+// one piece of a large port-to-port message, see packets/fragments.h 
+#define TKEY_PORTFRAG 36 
+
+// for interned routes (see packets/route_ids.h), 
+// | TKEY_RIDF | label | replaces the whole route, 
+#define TKEY_RIDF 16 
+// and these install it, hop by hop: | KEY | index:2 | label:2 | 
+#define TKEY_LINKF_RI 17 
+#define TKEY_PORTPACK_RI 34 
+
 // for runtime info 
 #define TKEY_RUNTIMEINFO_REQ 101
 #define TKEY_RUNTIMEINFO_RES 102 
 // port info (type maps) 
 #define TKEY_PORTINFO_REQ 103
 #define TKEY_PORTINFO_RES 104
-// gateway info (type, state maps) 
+// gateway info (type, state maps), links report | TYPE | OPEN | MTU:2 | apiece (see OSAP_VERSION_LINK_MTU_MID) 
 #define TKEY_LGATEWAYINFO_REQ 105
 #define TKEY_LGATEWAYINFO_RES 106 
 #define TKEY_BGATEWAYINFO_REQ 107
 #define TKEY_BGATEWAYINFO_RES 108 
+// runtime statistics (counters, peaks) 
+#define TKEY_STATS_REQ 109 
+#define TKEY_STATS_RES 110 
+// code-log ring 
+#define TKEY_LOG_REQ 111 
+#define TKEY_LOG_RES 112 
+// batched discovery: runtime info, ports + names, gateways, in as few pages as possible 
+#define TKEY_DISCOVER_REQ 113 
+#define TKEY_DISCOVER_RES 114 
 
 // transport layer increments 
 
 #define TKEY_LINKF_INC 3 
 #define TKEY_BUSF_INC 5 
+#define TKEY_BUSB_INC 5 
+#define TKEY_LINKF_S_INC 2 
+#define TKEY_PORTPACK_S_INC 3 
+#define TKEY_RIDF_INC 2 
+#define TKEY_LINKF_RI_INC 5 
+
+// stats-query selections 
+
+#define STATSKEY_RUNTIME 0 
+#define STATSKEY_PORTS 1 
+#define STATSKEY_LGATEWAYS 2 
+#define STATSKEY_BGATEWAYS 3 
+
+// discovery sections, 
+
+#define DISCOVERKEY_RUNTIME 1 
+#define DISCOVERKEY_PORTS 2 
+#define DISCOVERKEY_LGATEWAYS 3 
+#define DISCOVERKEY_BGATEWAYS 4 
+#define DISCOVERKEY_CONTINUE 5 
+#define DISCOVERKEY_END 6 
 
 // build type keys 
 
@@ -51,6 +97,10 @@
 #define PTYPEKEY_ONE_PIPE_LISTENER 10 
 #define PTYPEKEY_AUTO_RPC_IMPLEMENTER 11
 #define PTYPEKEY_AUTO_RPC_CALLER 12
+#define PTYPEKEY_TRACE 13
+#define PTYPEKEY_TRAVERSAL 14
+#define PTYPEKEY_AUTO_RPC_DISPATCHER 15
+#define PTYPEKEY_RELIABLE 16
 
 // link-gateway type keys:
 
@@ -58,5 +108,13 @@
 #define LGATEWAYTYPEKEY_UNKNOWN 1
 #define LGATEWAYTYPEKEY_USBSERIAL 2 
 #define LGATEWAYTYPEKEY_UART 3
+#define LGATEWAYTYPEKEY_SIMULATED 4
+
+// bus-gateway type keys:
+
+#define BGATEWAYTYPEKEY_NULL 0 
+#define BGATEWAYTYPEKEY_UNKNOWN 1 
+#define BGATEWAYTYPEKEY_SIMULATED 2 
+#define BGATEWAYTYPEKEY_UART 3 
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,71 @@
+// code-logging ring 
+
+#include "log.h"
+
+static_assert((OSAP_CONFIG_LOG_LENGTH & (OSAP_CONFIG_LOG_LENGTH - 1)) == 0, "OSAP_CONFIG_LOG_LENGTH must be a power of two");
+
+typedef struct LogRecord {
+  uint32_t time;
+  uint8_t code;
+  uint8_t suppressed;
+  uint16_t arg;
+} LogRecord;
+
+LogRecord logRing[OSAP_CONFIG_LOG_LENGTH];
+uint32_t logHead = 0;
+uint32_t logDropped = 0;
+
+// rate limiting is a token bucket: we hold up to _BURST tokens, 
+// regaining one every _REFILL_MS, each write spends one 
+uint8_t logTokens = OSAP_CONFIG_LOG_BURST;
+uint32_t logLastRefill = 0;
+uint8_t logSuppressed = 0;
+
+void logWrite(uint8_t code, uint16_t arg){
+  uint32_t now = millis();
+  // refill, 
+  uint32_t elapsed = now - logLastRefill;
+  if(elapsed >= OSAP_CONFIG_LOG_REFILL_MS){
+    uint32_t gain = elapsed / OSAP_CONFIG_LOG_REFILL_MS;
+    logTokens = (logTokens + gain > OSAP_CONFIG_LOG_BURST) ? OSAP_CONFIG_LOG_BURST : logTokens + gain;
+    logLastRefill += gain * OSAP_CONFIG_LOG_REFILL_MS;
+  }
+  // drop if we're bursting, 
+  if(logTokens == 0){
+    logDropped ++;
+    if(logSuppressed < 255) logSuppressed ++;
+    return;
+  }
+  logTokens --;
+  // write it, 
+  LogRecord* rec = &(logRing[logHead & (OSAP_CONFIG_LOG_LENGTH - 1)]);
+  rec->time = now;
+  rec->code = code;
+  rec->suppressed = logSuppressed;
+  rec->arg = arg;
+  logSuppressed = 0;
+  logHead ++;
+}
+
+uint32_t logGetHead(void){
+  return logHead;
+}
+
+uint32_t logGetDropped(void){
+  return logDropped;
+}
+
+boolean logRead(uint32_t i, uint8_t* dest){
+  if(i >= logHead) return false;
+  if(logHead - i > OSAP_CONFIG_LOG_LENGTH) return false;
+  LogRecord* rec = &(logRing[i & (OSAP_CONFIG_LOG_LENGTH - 1)]);
+  dest[0] = rec->time & 255;
+  dest[1] = (rec->time >> 8) & 255;
+  dest[2] = (rec->time >> 16) & 255;
+  dest[3] = (rec->time >> 24) & 255;
+  dest[4] = rec->code;
+  dest[5] = rec->suppressed;
+  dest[6] = rec->arg & 255;
+  dest[7] = (rec->arg >> 8) & 255;
+  return true;
+}
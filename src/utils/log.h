@@ -0,0 +1,89 @@
+/*
+utils/log.h
+
+allocation-free error / debug logging: codes + an integer arg into a ring, 
+formatting is done host-side
+
+Jake Read at the Center for Bits and Atoms
+(c) Massachusetts Institute of Technology 2022
+
+This work may be reproduced, modified, distributed, performed, and
+displayed for any purpose, but must acknowledge the osap project.
+Copyright is retained and must be preserved. The work is provided as is;
+no warranty is provided, and users accept all liability.
+*/
+
+#ifndef OSAP_LOG_H_
+#define OSAP_LOG_H_
+
+#include <Arduino.h>
+#include "../osap_config.h"
+
+// -------------------------------- Log Codes 
+// the host keeps the matching format strings, i.e. 
+// LOGCODE_PORTPACK_BAD_PORT -> "msg to non-existent port {arg}" 
+
+#define LOGCODE_NONE 0 
+// routing, 
+#define LOGCODE_PACKET_TIMEOUT 1          // arg: tkey 
+#define LOGCODE_PORTPACK_BAD_PORT 2       // arg: destination port index 
+#define LOGCODE_LINKF_BAD_LINK 3          // arg: link index 
+#define LOGCODE_BUSF_BAD_BUS 4            // arg: bus index 
+#define LOGCODE_BUSSES_NOT_INCLUDED 5 
+#define LOGCODE_INFO_RES_UNEXPECTED 6     // arg: tkey 
+#define LOGCODE_BAD_TKEY 7                // arg: tkey 
+#define LOGCODE_BAD_STATS_SELECT 8        // arg: select 
+#define LOGCODE_INGEST_BAD_PTR 9          // arg: link index 
+#define LOGCODE_BAD_KEY_INCREMENT 10      // arg: key 
+#define LOGCODE_ROUTEID_MISS 11           // arg: label 
+#define LOGCODE_ROUTEIDS_NOT_INCLUDED 12  // arg: tkey 
+#define LOGCODE_LINKF_OVERSIZE 13         // arg: packet length 
+#define LOGCODE_DISCOVER_SKIPPED 14       // arg: section << 8 | item index 
+// packet authorship, 
+#define LOGCODE_OVERSIZE_RAW_WRITE 20     // arg: attempted length 
+#define LOGCODE_OVERSIZE_PORT_WRITE 21    // arg: attempted length 
+#define LOGCODE_PORT_ALLOCATE_FAIL 22     // arg: port index 
+#define LOGCODE_FRAG_TOO_LARGE 23         // arg: fragment count 
+#define LOGCODE_FRAG_DROPPED 24           // arg: source port 
+#define LOGCODE_FRAG_TIMEOUT 25           // arg: source port 
+// structure, 
+#define LOGCODE_TOO_MANY_PORTS 30 
+#define LOGCODE_TOO_MANY_LGATEWAYS 31 
+#define LOGCODE_TOO_MANY_BGATEWAYS 32 
+// port integrations, 
+#define LOGCODE_PORT_BAD_KEY 40           // arg: port type key << 8 | msg key 
+#define LOGCODE_PNAMED_UNEXPECTED_RES 41  // arg: msg key 
+#define LOGCODE_RPC_BAD_INDEX 42          // arg: function index 
+#define LOGCODE_RPC_BAD_ARGS 43           // arg: function index (or 0) 
+#define LOGCODE_RPC_RESULT_TOO_LARGE 44   // arg: function index (or 0) 
+#define LOGCODE_RPC_PENDING_FULL 45       // arg: msg id 
+#define LOGCODE_RPC_PENDING_TIMEOUT 46    // arg: msg id 
+#define LOGCODE_SUB_FULL 47               // arg: msg id 
+#define LOGCODE_SUB_ENDED 48              // arg: reason << 8 | msg id, see runtime/subscriptions.h 
+#define LOGCODE_PONEPIPE_FULL 49          // arg: source port 
+#define LOGCODE_PREL_RESET 50             // arg: reason, see port_integrations/port_reliable.h 
+#define LOGCODE_PNAMED_REPLY_TOO_LARGE 51 // arg: reply length 
+#define LOGCODE_RPC_SIG_SKIPPED 52        // arg: function index 
+
+// -------------------------------- The Ring 
+
+// each record is | TIME:4 (millis) | CODE:1 | SUPPRESSED:1 | ARG:2 |, 
+// where SUPPRESSED counts (saturating) writes dropped by the rate limit just before this one 
+#define OSAP_LOG_RECORD_SIZE 8 
+
+// write one record, this is a handful of stores (or fewer, when rate-limited) 
+void logWrite(uint8_t code, uint16_t arg);
+// count of records ever-written, the ring holds the last OSAP_CONFIG_LOG_LENGTH 
+uint32_t logGetHead(void);
+// total dropped by the rate limiter 
+uint32_t logGetDropped(void);
+// copies record at absolute index `i` into `dest`, returns false if gone or not-yet written 
+boolean logRead(uint32_t i, uint8_t* dest);
+
+#ifdef OSAP_CONFIG_INCLUDE_ERROR_MSGS
+#define OSAP_LOG(code, arg) logWrite(code, arg)
+#else
+#define OSAP_LOG(code, arg)
+#endif 
+
+#endif 
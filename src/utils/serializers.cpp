@@ -18,6 +18,18 @@ uint16_t serializers_readUint16(uint8_t* buf, uint16_t offset){
   return (buf[offset + 1] << 8) | buf[offset];
 }
 
+// 32-bit, ptr-is-ptr 
+void serializers_writeUint32(uint8_t* buf, uint16_t* wptr, uint32_t val){
+  buf[(*wptr) ++] = val & 255;
+  buf[(*wptr) ++] = (val >> 8) & 255;
+  buf[(*wptr) ++] = (val >> 16) & 255;
+  buf[(*wptr) ++] = (val >> 24) & 255;
+}
+
+uint32_t serializers_readUint32(uint8_t* buf, uint16_t offset){
+  return ((uint32_t)buf[offset + 3] << 24) | ((uint32_t)buf[offset + 2] << 16) | ((uint32_t)buf[offset + 1] << 8) | buf[offset];
+}
+
 // ptr is ptr...
 void serializers_writeString(uint8_t* buf, uint16_t* wptr, char* val){
   // add one to the len so that we include the trailing zero and 
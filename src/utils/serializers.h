@@ -12,6 +12,10 @@ void serializers_writeUint16(uint8_t* buf, uint16_t offset, uint16_t val);
 uint16_t serializers_readUint16(uint8_t* buf, uint16_t offset);
 // read w/ ptr passalong 
 
+// 32-bit variants, for counters etc 
+void serializers_writeUint32(uint8_t* buf, uint16_t* wptr, uint32_t val);
+uint32_t serializers_readUint32(uint8_t* buf, uint16_t offset);
+
 // write 
 void serializers_writeString(uint8_t* buf, uint16_t* wptr, char* val);
 // read from buf[offset], into to dest, to at most <maxLen>
@@ -2,6 +2,8 @@
 #define TEMPLATE_SERIALIZERS_H_
 
 #include <Arduino.h>
+#include <type_traits>
+#include <array>
 #include "../osap.h"
 
 // --------------------------  We declare a unit type, for void-passers
@@ -9,145 +11,253 @@
 struct Unit{};
 constexpr Unit unit{};
 
-// --------------------------  Key Codes 
+// --------------------------  Key Codes
 
-#define TYPEKEY_VOID 0 
-#define TYPEKEY_INT 1
+#define TYPEKEY_VOID 0
+#define TYPEKEY_INT 1         // 32 bit, signed
 #define TYPEKEY_BOOL 2
 #define TYPEKEY_FLOAT 3
-#define TYPEKEY_STRING 4 
+#define TYPEKEY_STRING 4
+#define TYPEKEY_UINT8 5
+#define TYPEKEY_INT8 6
+#define TYPEKEY_UINT16 7
+#define TYPEKEY_INT16 8
+#define TYPEKEY_UINT32 9
+#define TYPEKEY_INT64 10
+#define TYPEKEY_UINT64 11
+#define TYPEKEY_DOUBLE 12
+// arrays are the element's key w/ this bit set, and are | COUNT:2 | ELEMENTS... | on the wire,
+#define TYPEKEY_ARRAY 128
 
+// --------------------------  Views Into the Packet
+
+// a span of fixed-width values, i.e. a `RPCSpan<float>` argument is the floats as they sit
+// in the packet, w/o a copy: so it's only valid during the call, and elements are read out
+// one at a time (they may not be aligned),
 template<typename T>
-uint8_t getTypeKey(void){
-  return 0;
-}
-template<> inline
-uint8_t getTypeKey<Unit>(void){
-  return TYPEKEY_VOID;
-}
-template<> inline 
-uint8_t getTypeKey<int>(void){
-  return TYPEKEY_INT;
-}
-template<> inline                     // boolean
-uint8_t getTypeKey<boolean>(void){
-  return TYPEKEY_BOOL;
-}
-template<> inline                   // floats
-uint8_t getTypeKey<float>(void){
-  return TYPEKEY_FLOAT;
-}
-template<> inline 
-uint8_t getTypeKey<char*>(void){
-  return TYPEKEY_STRING;
-}
-template<> inline
-uint8_t getTypeKey<String>(void){
-  return TYPEKEY_STRING;
-}
+struct RPCSpan {
+  static_assert(std::is_arithmetic<T>::value, "RPCSpan is for fixed-width values");
+  const uint8_t* bytes = nullptr;
+  uint16_t count = 0;
+  RPCSpan(void){}
+  // or, to return one of our own,
+  RPCSpan(const T* data, uint16_t _count) : bytes((const uint8_t*)data), count(_count) {}
+  uint16_t size(void) const { return count; }
+  T operator[](size_t i) const {
+    T val;
+    memcpy(&val, &(bytes[i * sizeof(T)]), sizeof(T));
+    return val;
+  }
+};
 
+// and strings, likewise,
+struct RPCString {
+  const char* chars = nullptr;
+  uint8_t len = 0;
+  RPCString(void){}
+  RPCString(const char* _chars) : chars(_chars), len(strlen(_chars)) {}
+};
 
-// --------------------------  Unions (serdes utes) 
+// --------------------------  Codecs
+// each type gets a specialization here, w/ its key, and a writer and reader that are
+// length-guarded: if a value doesn't fit, nothing is written (or it's read as T{})
+// and the pointer is pushed past the end, so that one check after a run of them will do,
+// types w/o a codec are a compile-time error,
 
-union chunk_float32 {
-  uint8_t bytes[4];
-  float f;
+template<typename T, typename Enable = void>
+struct TypeCodec {
+  static_assert(sizeof(T) == 0, "no rpc serializer for this type, see utils/template_serializers.h");
 };
 
-// --------------------------  Serializing 
-// TODO: do they write keys, or not ? we could have serialize_tight() and serialize_safe()
-// TODO: serializers should be length-guarded: serialize(var, buffer, wptr, maxsize)
-// ... they could simply stop writing in those cases 
+// marks a short read / write,
+inline void codecOverrun(size_t* ptr, size_t max){
+  *ptr = max + 1;
+}
 
+template<>
+struct TypeCodec<Unit> {
+  static constexpr uint8_t key = TYPEKEY_VOID;
+};
+
+template<>
+struct TypeCodec<bool> {
+  static constexpr uint8_t key = TYPEKEY_BOOL;
+  static void write(bool var, uint8_t* buffer, size_t* wptr, size_t max){
+    if(*wptr + 1 > max) return codecOverrun(wptr, max);
+    buffer[(*wptr) ++] = var ? 1 : 0;
+  }
+  static bool read(uint8_t* buffer, size_t* rptr, size_t len){
+    if(*rptr + 1 > len){ codecOverrun(rptr, len); return false; }
+    return buffer[(*rptr) ++];
+  }
+};
+
+// all of the integers, by size and sign, little-endian,
 template<typename T>
-void serialize(T var, uint8_t* buffer, size_t* wptr){}
-
-template<>inline
-void serialize<int>(int var, uint8_t* buffer, size_t* wptr){
-  buffer[(*wptr) ++] = var & 255;
-  buffer[(*wptr) ++] = (var >> 8) & 255;
-  buffer[(*wptr) ++] = (var >> 16) & 255;
-  buffer[(*wptr) ++] = (var >> 24) & 255;
-}
+struct TypeCodec<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+  static constexpr uint8_t key = std::is_signed<T>::value ?
+    (sizeof(T) == 1 ? TYPEKEY_INT8 : sizeof(T) == 2 ? TYPEKEY_INT16 : sizeof(T) == 4 ? TYPEKEY_INT : TYPEKEY_INT64) :
+    (sizeof(T) == 1 ? TYPEKEY_UINT8 : sizeof(T) == 2 ? TYPEKEY_UINT16 : sizeof(T) == 4 ? TYPEKEY_UINT32 : TYPEKEY_UINT64);
+  static void write(T var, uint8_t* buffer, size_t* wptr, size_t max){
+    if(*wptr + sizeof(T) > max) return codecOverrun(wptr, max);
+    typename std::make_unsigned<T>::type u = var;
+    for(size_t b = 0; b < sizeof(T); b ++){
+      buffer[(*wptr) ++] = u & 255;
+      u >>= (sizeof(T) > 1) ? 8 : 0;
+    }
+  }
+  static T read(uint8_t* buffer, size_t* rptr, size_t len){
+    if(*rptr + sizeof(T) > len){ codecOverrun(rptr, len); return 0; }
+    typename std::make_unsigned<T>::type u = 0;
+    for(size_t b = 0; b < sizeof(T); b ++){
+      u |= (typename std::make_unsigned<T>::type)buffer[(*rptr) ++] << (8 * b);
+    }
+    return (T)u;
+  }
+};
 
-template<>inline 
-void serialize<bool>(bool var, uint8_t* buffer, size_t* wptr){
-  buffer[(*wptr) ++] = var ? 1 : 0;
-}
+// floats (and doubles, which are floats on AVR) are copied as they sit,
+template<typename T>
+struct TypeCodec<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+  static constexpr uint8_t key = (sizeof(T) == 4) ? TYPEKEY_FLOAT : TYPEKEY_DOUBLE;
+  static void write(T var, uint8_t* buffer, size_t* wptr, size_t max){
+    if(*wptr + sizeof(T) > max) return codecOverrun(wptr, max);
+    memcpy(&(buffer[*wptr]), &var, sizeof(T));
+    (*wptr) += sizeof(T);
+  }
+  static T read(uint8_t* buffer, size_t* rptr, size_t len){
+    if(*rptr + sizeof(T) > len){ codecOverrun(rptr, len); return 0; }
+    T var;
+    memcpy(&var, &(buffer[*rptr]), sizeof(T));
+    (*rptr) += sizeof(T);
+    return var;
+  }
+};
 
-template<>inline
-void serialize<float>(float var, uint8_t* buffer, size_t* wptr){
-  chunk_float32 chunk;
-  chunk.f = var;
-  buffer[(*wptr) ++] = chunk.bytes[0]; 
-  buffer[(*wptr) ++] = chunk.bytes[1]; 
-  buffer[(*wptr) ++] = chunk.bytes[2]; 
-  buffer[(*wptr) ++] = chunk.bytes[3]; 
-}
+// strings are | TYPEKEY_STRING | LEN | CHARS... |, w/o the trailing zero,
+template<>
+struct TypeCodec<RPCString> {
+  static constexpr uint8_t key = TYPEKEY_STRING;
+  static void write(RPCString var, uint8_t* buffer, size_t* wptr, size_t max){
+    if(*wptr + 2 + var.len > max) return codecOverrun(wptr, max);
+    buffer[(*wptr) ++] = TYPEKEY_STRING;
+    buffer[(*wptr) ++] = var.len;
+    memcpy(&(buffer[*wptr]), var.chars, var.len);
+    (*wptr) += var.len;
+  }
+  static RPCString read(uint8_t* buffer, size_t* rptr, size_t len){
+    RPCString str;
+    if(*rptr + 2 > len || buffer[*rptr] != TYPEKEY_STRING || *rptr + 2 + buffer[*rptr + 1] > len){
+      codecOverrun(rptr, len);
+      return str;
+    }
+    str.len = buffer[*rptr + 1];
+    str.chars = (const char*)&(buffer[*rptr + 2]);
+    (*rptr) += 2 + str.len;
+    return str;
+  }
+};
 
-template<>inline 
-void serialize<char*>(char* var, uint8_t* buffer, size_t* wptr){
-  buffer[(*wptr) ++] = TYPEKEY_STRING;
-  size_t len = strlen(var);
-  buffer[(*wptr) ++] = len;
-  // this should copy the string but not its trailing zero, 
-  memcpy(&(buffer[*wptr]), var, len);
-  (*wptr) += len;
-}
+template<>
+struct TypeCodec<char*> {
+  static constexpr uint8_t key = TYPEKEY_STRING;
+  static void write(char* var, uint8_t* buffer, size_t* wptr, size_t max){
+    TypeCodec<RPCString>::write(RPCString(var), buffer, wptr, max);
+  }
+  // w/o a trailing zero in the packet, we can't hand these out, use RPCString
+};
+
+template<>
+struct TypeCodec<const char*> : TypeCodec<char*> {
+  static void write(const char* var, uint8_t* buffer, size_t* wptr, size_t max){
+    TypeCodec<RPCString>::write(RPCString(var), buffer, wptr, max);
+  }
+};
 
-// --------------------------  Deserializing 
+// we can expose our serialized 'string' as an arduino String for convenience / familiarity,
+// built straight from the packet (this used to go thru a global 256 byte stash) 
+template<>
+struct TypeCodec<String> {
+  static constexpr uint8_t key = TYPEKEY_STRING;
+  static void write(String var, uint8_t* buffer, size_t* wptr, size_t max){
+    TypeCodec<RPCString>::write(RPCString(var.c_str()), buffer, wptr, max);
+  }
+  static String read(uint8_t* buffer, size_t* rptr, size_t len){
+    RPCString str = TypeCodec<RPCString>::read(buffer, rptr, len);
+    String out;
+    out.reserve(str.len);
+    for(uint8_t c = 0; c < str.len; c ++) out += str.chars[c];
+    return out;
+  }
+};
 
+// spans are | COUNT:2 | ELEMENTS... |,
 template<typename T>
-T deserialize(uint8_t* buffer, size_t* rptr){}
-
-template<>inline 
-int deserialize<int>(uint8_t* buffer, size_t* rptr){
-  int val = 0;
-  val |= buffer[(*rptr) ++];
-  val |= buffer[(*rptr) ++] << 8;
-  val |= buffer[(*rptr) ++] << 16;
-  val |= buffer[(*rptr) ++] << 24;
-  return val; 
-}
+struct TypeCodec<RPCSpan<T>> {
+  static constexpr uint8_t key = TYPEKEY_ARRAY | TypeCodec<T>::key;
+  static void write(RPCSpan<T> var, uint8_t* buffer, size_t* wptr, size_t max){
+    size_t bytes = (size_t)var.count * sizeof(T);
+    if(*wptr + 2 + bytes > max) return codecOverrun(wptr, max);
+    buffer[(*wptr) ++] = var.count & 255;
+    buffer[(*wptr) ++] = var.count >> 8;
+    memcpy(&(buffer[*wptr]), var.bytes, bytes);
+    (*wptr) += bytes;
+  }
+  static RPCSpan<T> read(uint8_t* buffer, size_t* rptr, size_t len){
+    RPCSpan<T> span;
+    if(*rptr + 2 > len){ codecOverrun(rptr, len); return span; }
+    uint16_t count = buffer[*rptr] | (buffer[*rptr + 1] << 8);
+    if(*rptr + 2 + (size_t)count * sizeof(T) > len){ codecOverrun(rptr, len); return span; }
+    span.bytes = &(buffer[*rptr + 2]);
+    span.count = count;
+    (*rptr) += 2 + (size_t)count * sizeof(T);
+    return span;
+  }
+};
+
+// and fixed arrays are the same on the wire, but have to arrive w/ exactly N,
+template<typename T, size_t N>
+struct TypeCodec<std::array<T, N>> {
+  static_assert(N < 65536, "rpc arrays have at most 65535 elements");
+  static constexpr uint8_t key = TYPEKEY_ARRAY | TypeCodec<T>::key;
+  static void write(const std::array<T, N>& var, uint8_t* buffer, size_t* wptr, size_t max){
+    if(*wptr + 2 + N * sizeof(T) > max) return codecOverrun(wptr, max);
+    buffer[(*wptr) ++] = N & 255;
+    buffer[(*wptr) ++] = N >> 8;
+    for(size_t i = 0; i < N; i ++) TypeCodec<T>::write(var[i], buffer, wptr, max);
+  }
+  static std::array<T, N> read(uint8_t* buffer, size_t* rptr, size_t len){
+    std::array<T, N> arr = { };
+    RPCSpan<T> span = TypeCodec<RPCSpan<T>>::read(buffer, rptr, len);
+    if(span.bytes == nullptr) return arr;
+    if(span.count != N){ codecOverrun(rptr, len); return arr; }
+    for(size_t i = 0; i < N; i ++) arr[i] = span[i];
+    return arr;
+  }
+};
+
+// --------------------------  The API
+// args may be const-refs, which are decoded as their values,
 
-template<>inline 
-bool deserialize<bool>(uint8_t* buffer, size_t* rptr){
-  return buffer[(*rptr) ++];
+template<typename T>
+constexpr uint8_t getTypeKey(void){
+  if constexpr (std::is_void<T>::value){
+    return TYPEKEY_VOID;
+  } else {
+    return TypeCodec<typename std::decay<T>::type>::key;
+  }
 }
 
-template<>inline 
-float deserialize<float>(uint8_t* buffer, size_t* rptr){
-  chunk_float32 chunk = {
-    .bytes = {
-      buffer[(*rptr) ++],
-      buffer[(*rptr) ++],
-      buffer[(*rptr) ++],
-      buffer[(*rptr) ++],
-    }
-  };
-  return chunk.f;
+// writes var at *wptr, unless that would run past max,
+template<typename T>
+void serialize(const T& var, uint8_t* buffer, size_t* wptr, size_t max){
+  TypeCodec<typename std::decay<T>::type>::write(var, buffer, wptr, max);
 }
 
-// fk it, we can expose our serialized 'string' as an arduino String 
-// for convenience / familiarity... nothing in-system uses this, so 
-// flash shouldn't be affected until it's invoked ~ 
-char string_stash[256] = { 'h', 'e', 'l', 'l', 'o' };
-template<>inline 
-String deserialize<String>(uint8_t* buffer, size_t* rptr){
-  // ok, we can check for our bytecode:
-  if(buffer[(*rptr)] != TYPEKEY_STRING){
-    return "str_err";
-  }
-  // otherwise we have this len to unpack:
-  size_t len = buffer[(*rptr) + 1];
-  // copy those into our stash and stuff a null terminator: 
-  memcpy(string_stash, &(buffer[(*rptr) + 2]), len);
-  string_stash[len] = '\0';
-  // don't forget to increment the rptr accordingly
-  *rptr += len + 2;
-  // a new String, on the stack, to return: 
-  return string_stash;
-  // return String(string_stash);
+// reads one at *rptr, unless it would run past len,
+template<typename T>
+typename std::decay<T>::type deserialize(uint8_t* buffer, size_t* rptr, size_t len){
+  return TypeCodec<typename std::decay<T>::type>::read(buffer, rptr, len);
 }
 
-#endif 
\ No newline at end of file
+#endif
@@ -0,0 +1,66 @@
+// tracing ring 
+
+#include "trace.h"
+
+#ifdef OSAP_CONFIG_INCLUDE_TRACE
+
+// use the cycle counter where we have one (M3 / M4 / M7), 
+// M0+ (i.e. SAMD21, RP2040) doesn't, so falls back to micros() 
+#if defined(OSAP_CONFIG_TRACE_USE_DWT) && defined(DWT) && defined(CoreDebug_DEMCR_TRCENA_Msk)
+#define TRACE_NOW() (DWT->CYCCNT)
+#define TRACE_TIMEBASE TRACE_TIMEBASE_CYCLES
+#else 
+#define TRACE_NOW() micros()
+#define TRACE_TIMEBASE TRACE_TIMEBASE_MICROS
+#endif 
+
+static_assert((OSAP_CONFIG_TRACE_LENGTH & (OSAP_CONFIG_TRACE_LENGTH - 1)) == 0, "OSAP_CONFIG_TRACE_LENGTH must be a power of two");
+
+TraceEvent traceRing[OSAP_CONFIG_TRACE_LENGTH];
+uint32_t traceHead = 0;
+
+void traceBegin(void){
+  #if TRACE_TIMEBASE == TRACE_TIMEBASE_CYCLES
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  #endif 
+  traceHead = 0;
+}
+
+void traceWrite(uint8_t event, uint8_t arg8, uint16_t arg16){
+  // the length is a power of two, so this is a mask, not a divide 
+  TraceEvent* evt = &(traceRing[traceHead & (OSAP_CONFIG_TRACE_LENGTH - 1)]);
+  evt->time = TRACE_NOW();
+  evt->event = event;
+  evt->arg8 = arg8;
+  evt->arg16 = arg16;
+  traceHead ++;
+}
+
+uint32_t traceGetHead(void){
+  return traceHead;
+}
+
+boolean traceRead(uint32_t i, uint8_t* dest){
+  // not-yet, or already gone: 
+  if(i >= traceHead) return false;
+  if(traceHead - i > OSAP_CONFIG_TRACE_LENGTH) return false;
+  TraceEvent* evt = &(traceRing[i & (OSAP_CONFIG_TRACE_LENGTH - 1)]);
+  // little-endian, as everywhere else on the wire 
+  dest[0] = evt->time & 255;
+  dest[1] = (evt->time >> 8) & 255;
+  dest[2] = (evt->time >> 16) & 255;
+  dest[3] = (evt->time >> 24) & 255;
+  dest[4] = evt->event;
+  dest[5] = evt->arg8;
+  dest[6] = evt->arg16 & 255;
+  dest[7] = (evt->arg16 >> 8) & 255;
+  return true;
+}
+
+uint8_t traceGetTimebase(void){
+  return TRACE_TIMEBASE;
+}
+
+#endif 
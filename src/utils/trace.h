@@ -0,0 +1,68 @@
+/*
+utils/trace.h
+
+fixed-size binary event tracing for the hot path 
+
+Jake Read at the Center for Bits and Atoms
+(c) Massachusetts Institute of Technology 2022
+
+This work may be reproduced, modified, distributed, performed, and
+displayed for any purpose, but must acknowledge the osap project.
+Copyright is retained and must be preserved. The work is provided as is;
+no warranty is provided, and users accept all liability.
+*/
+
+#ifndef OSAP_TRACE_H_
+#define OSAP_TRACE_H_
+
+#include <Arduino.h>
+#include "../osap_config.h"
+
+// event keys: each trace record is | TIME:4 | EVENT:1 | ARG8:1 | ARG16:2 |, 
+// on the host (see OSAP_Port_Trace for the dump format), these map onto a 
+// chrome-trace / perfetto timeline as: _ENTER / _EXIT pairs -> "B" / "E" duration 
+// events, _ALLOC / _FREE pairs -> async "b" / "e" spans w/ the stack slot as id, 
+// and everything else -> "i" instants w/ args attached 
+
+#define TRACE_EVT_LOOP_ENTER 1 
+#define TRACE_EVT_LOOP_EXIT 2       // arg16: n packets to service 
+#define TRACE_EVT_ALLOC 3           // arg8: 0 port, 1 link, 2 bus, arg16: stack slot 
+#define TRACE_EVT_FREE 4            // arg8: 0 port, 1 link, 2 bus, arg16: stack slot 
+#define TRACE_EVT_INGEST 5          // arg8: 0 link, 1 bus, arg16: gateway index 
+#define TRACE_EVT_SERVICE 6         // arg8: tkey, arg16: position in this loop's service list 
+#define TRACE_EVT_SEND 7            // arg8: tkey, arg16: gateway index 
+#define TRACE_EVT_TIMEOUT 8         // arg8: tkey 
+#define TRACE_EVT_ONPACKET_ENTER 9  // arg16: port index 
+#define TRACE_EVT_ONPACKET_EXIT 10  // arg16: port index 
+
+// timebase keys, so the host knows how to scale TIME 
+#define TRACE_TIMEBASE_MICROS 0 
+#define TRACE_TIMEBASE_CYCLES 1 
+
+#ifdef OSAP_CONFIG_INCLUDE_TRACE
+
+typedef struct TraceEvent {
+  uint32_t time;
+  uint8_t event;
+  uint8_t arg8;
+  uint16_t arg16;
+} TraceEvent;
+
+// setup the timer (if we're using DWT), and clear the ring 
+void traceBegin(void);
+// write one event: this is the only thing on the hot path 
+void traceWrite(uint8_t event, uint8_t arg8, uint16_t arg16);
+// count of events ever-written, the ring holds the last OSAP_CONFIG_TRACE_LENGTH of 'em 
+uint32_t traceGetHead(void);
+// copies event at absolute index `i` into `dest` as 8 serialized bytes, 
+// returns false if that index has been overwritten or is not yet written 
+boolean traceRead(uint32_t i, uint8_t* dest);
+// reports TRACE_TIMEBASE_MICROS or _CYCLES 
+uint8_t traceGetTimebase(void);
+
+#define OSAP_TRACE(event, arg8, arg16) traceWrite(event, arg8, arg16)
+#else
+#define OSAP_TRACE(event, arg8, arg16)
+#endif 
+
+#endif 